@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <jg_algorithm.h>
+#include <jg_benchmark_runner.h>
+#include <jg_reduce.h>
+
+namespace {
+
+std::vector<long long> make_samples(size_t count)
+{
+    std::mt19937_64 engine{42};
+    std::uniform_int_distribution<long long> distribution{1000, 100000};
+    std::vector<long long> samples(count);
+
+    for (auto& sample : samples)
+        sample = distribution(engine);
+
+    return samples;
+}
+
+std::vector<long long> samples = make_samples(1000);
+std::vector<long long> shuffled = samples;
+std::vector<long long> scratch(samples.size());
+std::vector<double> doubles(samples.begin(), samples.end());
+std::mt19937_64 shuffle_engine{42};
+volatile long long sink;
+
+// jg::median without scratch reorders its input, so each sample gets freshly shuffled input.
+jg::benchmark_options shuffled_options()
+{
+    jg::benchmark_options options;
+    options.setup = [] { std::shuffle(shuffled.begin(), shuffled.end(), shuffle_engine); };
+    return options;
+}
+
+jg::benchmark_adder algorithm_benchmarks { "algorithm", {
+    jg::benchmark_case { "jg::average 1000", [] {
+        sink = jg::average(samples.begin(), samples.end());
+    }},
+    jg::benchmark_case { "jg::standard_deviation 1000", [] {
+        sink = jg::standard_deviation(samples.begin(), samples.end(), 50000LL);
+    }},
+    jg::benchmark_case { "jg::average 1000 doubles", [] {
+        sink = static_cast<long long>(jg::average(doubles.begin(), doubles.end()));
+    }},
+    jg::benchmark_case { "jg::standard_deviation 1000 doubles", [] {
+        sink = static_cast<long long>(jg::standard_deviation(doubles.begin(), doubles.end(), 50000.0));
+    }},
+    jg::benchmark_case { "jg::summarize 1000 doubles", [] {
+        sink = static_cast<long long>(jg::summarize(jg::span<const double>{doubles.data(), doubles.size()}).variance);
+    }},
+    jg::benchmark_case { "jg::summarize 1000 doubles, scalar", [] {
+        sink = static_cast<long long>(jg::summarize(jg::span<const double>{doubles.data(), doubles.size()}, jg::simd_level::scalar).variance);
+    }},
+    jg::benchmark_case { "jg::median 1000", shuffled_options(), [] {
+        sink = jg::median(shuffled.begin(), shuffled.end());
+    }},
+    jg::benchmark_case { "jg::median 1000, paused shuffle", [] (jg::benchmark_state& state) {
+        state.pause_timing();
+        std::shuffle(shuffled.begin(), shuffled.end(), shuffle_engine);
+        state.resume_timing();
+        sink = jg::median(shuffled.begin(), shuffled.end());
+    }},
+    jg::benchmark_case { "jg::median 1000, scratch", [] {
+        sink = jg::median(samples.begin(), samples.end(), jg::span<long long>{scratch.data(), scratch.size()});
+    }},
+    jg::benchmark_case { "jg::median 7, scratch", [] {
+        sink = jg::median(samples.begin(), samples.begin() + 7, jg::span<long long>{scratch.data(), scratch.size()});
+    }},
+    jg::benchmark_case { "jg::median_absolute_deviation 1000", [] {
+        sink = jg::median_absolute_deviation(samples.begin(), samples.end(), 50000LL);
+    }},
+    jg::benchmark_case { "jg::median_absolute_deviation 1000, scratch", [] {
+        sink = jg::median_absolute_deviation(samples.begin(), samples.end(), 50000LL, jg::span<long long>{scratch.data(), scratch.size()});
+    }},
+    jg::benchmark_case { "jg::median_and_deviation 1000, scratch", [] {
+        sink = jg::median_and_deviation(samples.begin(), samples.end(), jg::span<long long>{scratch.data(), scratch.size()}).median_abs_deviation;
+    }}
+}};
+
+}
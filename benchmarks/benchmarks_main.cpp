@@ -0,0 +1,15 @@
+// There should be NO benchmarks in this file. We only want to compile this file ONCE. It'll reduce the
+// total benchmark compilation time as only individual benchmarks in other translation units change.
+
+// Implementations of header-only jg facilities that the benchmarks depend on are compiled here, once.
+// JG_ALLOCATION_COUNTER_IMPL replaces the global operator new and delete, for --allocations.
+#define JG_ALLOCATION_COUNTER_IMPL
+#include <jg_allocation_counter.h>
+#define JG_OS_IMPL
+#include <jg_os.h>
+#define JG_SIMPLE_LOGGER_IMPL
+#include <jg_simple_logger.h>
+
+#define JG_BENCHMARK_MAIN
+#define JG_BENCHMARK_IMPL
+#include <jg_benchmark_runner.h>
@@ -0,0 +1,120 @@
+#include <string>
+#include <vector>
+#include <jg_benchmark_runner.h>
+#include <jg_os.h>
+#include <jg_simple_logger.h>
+
+namespace {
+
+const std::vector<const char*> logs_with_newline
+{
+    "abcdefghij\n", "bcdefghija\n", "cdefghijab\n", "defghijabc\n", "efghijabcd\n",
+    "fghijabcde\n", "ghijabcdef\n", "hijabcdefg\n", "ijabcdefgh\n", "jabcdefghi\n"
+};
+
+const std::vector<const char*> logs_without_newline
+{
+    "abcdefghij", "bcdefghija", "cdefghijab", "defghijabc", "efghijabcd",
+    "fghijabcde", "ghijabcdef", "hijabcdefg", "ijabcdefgh", "jabcdefghi"
+};
+
+std::vector<jg::timestamp> timestamps(100);
+std::vector<std::string> strings(100);
+std::vector<jg::log_event> events(100);
+
+// One of the to_string(timestamp) variants parked under #if 0 in jg_simple_logger.h, for comparing with
+// the current one: --a="simple_logger/jg::to_string(timestamp)" --b="simple_logger/to_string(timestamp) with std::to_string"
+std::string to_string_with_std_to_string(const jg::timestamp& time)
+{
+    std::string result;
+    result.reserve(sizeof("HH:MM:SS.mmm ") - 1);
+
+    const std::time_t tt = std::chrono::system_clock::to_time_t(time);
+    const std::tm tm = jg::os::localtime_safe(tt);
+    const auto ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(time - std::chrono::system_clock::from_time_t(tt)).count());
+
+    auto append = [&result] (int value, int width) {
+        for (int limit = 10; --width > 0; limit *= 10)
+            if (value < limit)
+                result += '0';
+
+        result += std::to_string(value);
+    };
+
+    append(tm.tm_hour, 2);
+    result += ':';
+    append(tm.tm_min, 2);
+    result += ':';
+    append(tm.tm_sec, 2);
+    result += '.';
+    append(ms, 3);
+    result += ' ';
+
+    return result;
+}
+
+// One record per iteration, for records/s.
+jg::benchmark_options record_options()
+{
+    jg::benchmark_options options{10, 10};
+    options.items_per_iteration = 1;
+    return options;
+}
+
+// Sub-100 ns operations, timed in cycles.
+jg::benchmark_options cycle_options()
+{
+    jg::benchmark_options options{10, 100};
+    options.cycle_timing = true;
+    return options;
+}
+
+jg::benchmark_adder simple_logger_benchmarks { "simple_logger", {
+    jg::benchmark_case { "jg::log_info with nl", record_options(), []
+    {
+        for (size_t i = 0; i < 10; ++i)
+            jg::log_info() << logs_with_newline[i];
+    }},
+    jg::benchmark_case { "jg::log_info_line no nl", record_options(), []
+    {
+        for (size_t i = 0; i < 10; ++i)
+            jg::log_info_line() << logs_without_newline[i];
+    }},
+    jg::benchmark_case { "jg_log_info with nl", record_options(), []
+    {
+        for (size_t i = 0; i < 10; ++i)
+            jg_log_info() << logs_with_newline[i];
+    }},
+    jg::benchmark_case { "jg_log_info_line no nl", record_options(), []
+    {
+        for (size_t i = 0; i < 10; ++i)
+            jg_log_info_line() << logs_without_newline[i];
+    }},
+    jg::benchmark_case { "jg::timestamp", cycle_options(), []
+    {
+        for (size_t i = 0; i < 100; ++i)
+            timestamps[i] = jg::timestamp();
+    }},
+    jg::benchmark_case { "jg::timestamp::now", cycle_options(), []
+    {
+        for (size_t i = 0; i < 100; ++i)
+            timestamps[i] = {std::chrono::system_clock::now()};
+    }},
+    jg::benchmark_case { "jg::to_string(timestamp)", {10, 100}, []
+    {
+        for (size_t i = 0; i < 100; ++i)
+            strings[i] = jg::to_string(timestamps[i]);
+    }},
+    jg::benchmark_case { "to_string(timestamp) with std::to_string", {10, 100}, []
+    {
+        for (size_t i = 0; i < 100; ++i)
+            strings[i] = to_string_with_std_to_string(timestamps[i]);
+    }},
+    jg::benchmark_case { "jg_new_log_event", cycle_options(), []
+    {
+        for (size_t i = 0; i < 100; ++i)
+            events[i] = jg_new_log_event(jg::log_level::info);
+    }}
+}};
+
+}
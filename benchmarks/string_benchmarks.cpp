@@ -0,0 +1,32 @@
+#include <string>
+#include <vector>
+#include <jg_benchmark_runner.h>
+#include <jg_string.h>
+
+namespace {
+
+const std::vector<std::string> words{"abcdefghij", "bcdefghija", "cdefghijab", "defghijabc", "efghijabcd"};
+std::string joined;
+
+// `bytes` processed per iteration, for bytes/s.
+jg::benchmark_options byte_options(size_t bytes)
+{
+    jg::benchmark_options options{10, 100};
+    options.bytes_per_iteration = bytes;
+    return options;
+}
+
+jg::benchmark_adder string_benchmarks { "string", {
+    jg::benchmark_case { "jg::join 5 words", byte_options(5 * 10 + 4 * 2), []
+    {
+        for (size_t i = 0; i < 100; ++i)
+            joined = jg::join(words.begin(), words.end(), ", ");
+    }},
+    jg::benchmark_case { "jg::split<5>", byte_options(19), []
+    {
+        for (size_t i = 0; i < 100; ++i)
+            (void)jg::split<5>("abc,def,ghi,jkl,mno", ',');
+    }}
+}};
+
+}
@@ -2,7 +2,14 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <numeric>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "jg_reduce.h"
+#include "jg_span.h"
 #include "jg_verify.h"
 
 namespace jg {
@@ -38,6 +45,33 @@ constexpr FwdIt find_if(FwdIt first, FwdIt last, Pred pred)
     return last;
 }
 
+} // namespace jg
+
+namespace jg::detail {
+
+/// Pointers and vector iterators, whose values are contiguous in memory. C++17 has no trait for it.
+template <typename It, typename T = typename std::iterator_traits<It>::value_type>
+constexpr bool is_contiguous_iterator_v = std::is_pointer_v<It> ||
+                                          std::is_same_v<It, typename std::vector<T>::iterator> ||
+                                          std::is_same_v<It, typename std::vector<T>::const_iterator>;
+
+/// Whether `[first, last)` of `FwdIt` can be reduced by the SIMD kernels of jg_reduce.h.
+template <typename FwdIt>
+constexpr bool is_simd_reducible_range_v = is_contiguous_iterator_v<FwdIt> && jg::is_simd_reducible_v<typename std::iterator_traits<FwdIt>::value_type>;
+
+template <typename FwdIt>
+auto to_span(FwdIt first, FwdIt last)
+{
+    using value_type = typename std::iterator_traits<FwdIt>::value_type;
+    return jg::span<const value_type>{&*first, static_cast<size_t>(std::distance(first, last))};
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// Sums contiguous doubles and 64-bit integers with the SIMD kernels of jg_reduce.h, and other ranges
+/// with `std::accumulate`.
 // TODO: Maybe make constexpr when jg requires C++20
 template <typename FwdIt>
 auto average(FwdIt first, FwdIt last)
@@ -46,7 +80,10 @@ auto average(FwdIt first, FwdIt last)
     static_assert(std::is_arithmetic_v<value_type>);
     jg::debug_verify(first != last);
 
-    return std::accumulate(first, last, value_type(0)) / std::distance(first, last);
+    if constexpr (detail::is_simd_reducible_range_v<FwdIt>)
+        return jg::sum(detail::to_span(first, last)) / std::distance(first, last);
+    else
+        return std::accumulate(first, last, value_type(0)) / std::distance(first, last);
 }
 
 // TODO: Maybe make constexpr when jg requires C++20
@@ -70,12 +107,109 @@ constexpr T abs_diff(T first, T second)
     return first >= second ? first - second : second - first;
 }
 
+} // namespace jg
+
+namespace jg::detail {
+
+template <typename T>
+void compare_exchange(T& first, T& second) noexcept
+{
+    const T low = std::min(first, second);
+    second = std::max(first, second);
+    first = low;
+}
+
+/// The largest range that `sort_small()` sorts with a sorting network.
+constexpr size_t sorting_network_max_size = 8;
+
+/// Sorts `[data, data + size)`, where `size` is at most `sorting_network_max_size`, with the optimal
+/// (fewest comparisons) sorting network of that size. The compare-exchanges are branch free min/max
+/// with a fixed sequence, so unlike `std::nth_element`, there are no mispredicted branches.
+template <typename T>
+void sort_small(T* data, size_t size) noexcept
+{
+    struct comparator final { unsigned char first, second; };
+
+    static constexpr comparator network2[] = {{0,1}};
+    static constexpr comparator network3[] = {{0,2},{0,1},{1,2}};
+    static constexpr comparator network4[] = {{0,1},{2,3},{0,2},{1,3},{1,2}};
+    static constexpr comparator network5[] = {{0,3},{1,4},{0,2},{1,3},{0,1},{2,4},{1,2},{3,4},{2,3}};
+    static constexpr comparator network6[] = {{0,5},{1,3},{2,4},{1,2},{3,4},{0,3},{2,5},{0,1},{2,3},{4,5},{1,2},{3,4}};
+    static constexpr comparator network7[] = {{0,6},{2,3},{4,5},{0,2},{1,4},{3,6},{0,1},{2,5},{3,4},{1,2},{4,6},{2,3},{4,5},{1,2},{3,4},{5,6}};
+    static constexpr comparator network8[] = {{0,2},{1,3},{4,6},{5,7},{0,4},{1,5},{2,6},{3,7},{0,1},{2,3},{4,5},{6,7},{2,4},{3,5},{1,4},{3,6},{1,2},{3,4},{5,6}};
+
+    auto apply = [data] (const auto& network) {
+        for (const auto& c : network)
+            compare_exchange(data[c.first], data[c.second]);
+    };
+
+    switch (size)
+    {
+        case 2: apply(network2); break;
+        case 3: apply(network3); break;
+        case 4: apply(network4); break;
+        case 5: apply(network5); break;
+        case 6: apply(network6); break;
+        case 7: apply(network7); break;
+        case 8: apply(network8); break;
+        default: jg::debug_verify(size <= 1); break;
+    }
+}
+
+/// The same value as `jg::median()`, the middle value, or the upper of the two middle values, of the
+/// non-empty `[data, data + size)`, which it reorders.
+template <typename T>
+T select_median(T* data, size_t size)
+{
+    if (size <= sorting_network_max_size)
+        sort_small(data, size);
+    else
+        std::nth_element(data, data + size / 2, data + size);
+
+    return data[size / 2];
+}
+
+/// Copies `[first, last)` to the start of `scratch`, and returns the number of copied values.
+template <typename FwdIt, typename T>
+size_t copy_to_scratch(FwdIt first, FwdIt last, jg::span<T> scratch)
+{
+    const auto size = static_cast<size_t>(std::distance(first, last));
+    jg::verify(scratch.size() >= size);
+    std::copy(first, last, scratch.begin());
+    return size;
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// The median of `[first, last)`, like `jg::median(first, last)`, but the range is left as is. The
+/// values are copied to, and reordered in, `scratch`, which must have room for all of them, so
+/// repeated calls don't allocate when the caller reuses the scratch.
+///
+/// @example
+///     std::vector<long long> scratch(samples.size());
+///     const auto m = jg::median(samples.begin(), samples.end(), jg::span<long long>{scratch.data(), scratch.size()});
+template <typename FwdIt, typename T>
+T median(FwdIt first, FwdIt last, jg::span<T> scratch)
+{
+    static_assert(std::is_arithmetic_v<T>);
+    jg::debug_verify(first != last);
+
+    return detail::select_median(scratch.data(), detail::copy_to_scratch(first, last, scratch));
+}
+
+
 template <typename T>
 constexpr T abs_diff_squared(T first, T second)
 {
     return abs_diff(first, second) * abs_diff(first, second);
 }
 
+/// The population standard deviation of `[first, last)` around `average`. The squared deviations are
+/// summed as doubles, so that large integers, like nanoseconds, don't overflow, and an integral
+/// `TReturn` is rounded to the nearest integer. Contiguous doubles and 64-bit integers are reduced with
+/// the SIMD kernels of jg_reduce.h. `jg::stats_accumulator` computes the average and the deviation in one pass.
 // TODO: Maybe make constexpr when jg requires C++20
 template <typename FwdIt, typename TAverage, typename TReturn = TAverage>
 TReturn standard_deviation(FwdIt first, FwdIt last, TAverage average)
@@ -84,11 +218,28 @@ TReturn standard_deviation(FwdIt first, FwdIt last, TAverage average)
     static_assert(std::is_arithmetic_v<value_type>);
     jg::debug_verify(first != last);
 
-    auto diff_squared = [average] (auto ack, auto value) {
-        return ack + abs_diff_squared(average, value);
-    };
+    const auto count = static_cast<double>(std::distance(first, last));
+    double sum_squares = 0;
+
+    if constexpr (detail::is_simd_reducible_range_v<FwdIt>)
+    {
+        sum_squares = jg::sum_of_squares(detail::to_span(first, last), static_cast<double>(average));
+    }
+    else
+    {
+        for (; first != last; ++first)
+        {
+            const double deviation = static_cast<double>(*first) - static_cast<double>(average);
+            sum_squares += deviation * deviation;
+        }
+    }
+
+    const double deviation = std::sqrt(sum_squares / count);
 
-    return static_cast<TReturn>(sqrt(std::accumulate(first, last, value_type(0), diff_squared) / std::distance(first, last)));
+    if constexpr (std::is_integral_v<TReturn>)
+        return static_cast<TReturn>(std::llround(deviation));
+    else
+        return static_cast<TReturn>(deviation);
 }
 
 // TODO: Maybe make constexpr when jg requires C++20
@@ -109,4 +260,262 @@ auto median_absolute_deviation(FwdIt first, FwdIt last, TMedian median)
     return jg::median(deviations.begin(), deviations.end());
 }
 
+/// The median absolute deviation from `median` of `[first, last)`, like the overload without `scratch`,
+/// but the deviations are stored in `scratch` instead of in a new vector.
+template <typename FwdIt, typename T>
+T median_absolute_deviation(FwdIt first, FwdIt last, T median, jg::span<T> scratch)
+{
+    static_assert(std::is_arithmetic_v<T>);
+    jg::debug_verify(first != last);
+
+    const auto size = static_cast<size_t>(std::distance(first, last));
+    jg::verify(scratch.size() >= size);
+
+    std::transform(first, last, scratch.begin(), [median] (T value) { return abs_diff(median, value); });
+
+    return detail::select_median(scratch.data(), size);
+}
+
+template <typename T>
+struct median_deviation final
+{
+    T median{};
+    T median_abs_deviation{};
+};
+
+/// The median of `[first, last)` and the median absolute deviation from it, with two selections in
+/// `scratch`, which must have room for all values, and without changing or allocating anything else.
+/// The second selection reuses the copy that the first one reordered, since the deviations don't
+/// depend on the order.
+template <typename FwdIt, typename T>
+median_deviation<T> median_and_deviation(FwdIt first, FwdIt last, jg::span<T> scratch)
+{
+    static_assert(std::is_arithmetic_v<T>);
+    jg::debug_verify(first != last);
+
+    const size_t size = detail::copy_to_scratch(first, last, scratch);
+    const T median = detail::select_median(scratch.data(), size);
+
+    for (size_t i = 0; i < size; ++i)
+        scratch[i] = abs_diff(median, scratch[i]);
+
+    return {median, detail::select_median(scratch.data(), size)};
+}
+
+/// Asymptotic complexity classes that `fit_complexity()` can fit measurements to.
+enum class complexity
+{
+    o_1,
+    o_log_n,
+    o_n,
+    o_n_log_n,
+    o_n_squared
+};
+
+constexpr std::string_view to_string(complexity complexity) noexcept
+{
+    switch (complexity)
+    {
+        case complexity::o_1:         return "O(1)";
+        case complexity::o_log_n:     return "O(log n)";
+        case complexity::o_n:         return "O(n)";
+        case complexity::o_n_log_n:   return "O(n log n)";
+        case complexity::o_n_squared: return "O(n^2)";
+        default:                      return "O(?)";
+    }
+}
+
+/// The evaluated function g(n) of a complexity class, as in f(n) = coefficient * g(n).
+inline double complexity_function(complexity complexity, double n)
+{
+    switch (complexity)
+    {
+        case complexity::o_1:         return 1.0;
+        case complexity::o_log_n:     return std::log2(n);
+        case complexity::o_n:         return n;
+        case complexity::o_n_log_n:   return n * std::log2(n);
+        case complexity::o_n_squared: return n * n;
+        default:                      return 1.0;
+    }
+}
+
+struct complexity_fit final
+{
+    jg::complexity complexity{};
+    double coefficient{}; // f(n) = coefficient * g(n)
+    double rms{};         // Root mean square error of the fit, relative to the mean of the measurements.
+};
+
+/// Least squares fits `complexity` to the measurements `[first_y, ...)` taken at the sizes `[first_n, last_n)`.
+template <typename FwdItN, typename FwdItY>
+complexity_fit fit_complexity(FwdItN first_n, FwdItN last_n, FwdItY first_y, complexity complexity)
+{
+    jg::debug_verify(first_n != last_n);
+
+    double sum_gy = 0;
+    double sum_gg = 0;
+    double sum_y = 0;
+    size_t count = 0;
+
+    auto y = first_y;
+    for (auto n = first_n; n != last_n; ++n, ++y, ++count)
+    {
+        const double g = complexity_function(complexity, static_cast<double>(*n));
+        sum_gy += g * static_cast<double>(*y);
+        sum_gg += g * g;
+        sum_y  += static_cast<double>(*y);
+    }
+
+    const double coefficient = sum_gg > 0 ? sum_gy / sum_gg : 0.0;
+
+    double sum_residual_squared = 0;
+
+    y = first_y;
+    for (auto n = first_n; n != last_n; ++n, ++y)
+    {
+        const double residual = static_cast<double>(*y) - coefficient * complexity_function(complexity, static_cast<double>(*n));
+        sum_residual_squared += residual * residual;
+    }
+
+    const double mean = sum_y / static_cast<double>(count);
+    const double rms  = std::sqrt(sum_residual_squared / static_cast<double>(count));
+
+    return {complexity, coefficient, mean > 0 ? rms / mean : rms};
+}
+
+/// Fits all complexity classes to the measurements `[first_y, ...)` taken at the sizes `[first_n, last_n)`
+/// and returns the fit with the smallest root mean square error.
+template <typename FwdItN, typename FwdItY>
+complexity_fit fit_complexity(FwdItN first_n, FwdItN last_n, FwdItY first_y)
+{
+    complexity_fit best = fit_complexity(first_n, last_n, first_y, complexity::o_1);
+
+    for (auto candidate : {complexity::o_log_n, complexity::o_n, complexity::o_n_log_n, complexity::o_n_squared})
+    {
+        const auto fit = fit_complexity(first_n, last_n, first_y, candidate);
+
+        if (fit.rms < best.rms)
+            best = fit;
+    }
+
+    return best;
+}
+
+struct mann_whitney_result final
+{
+    double u{};        // The U statistic of the first range.
+    double z{};        // Normal approximation of U, tie corrected. Positive if the first range tends to be larger.
+    double p_value{1}; // Two-sided.
+};
+
+/// Tests whether the values in `[first1, last1)` tend to be larger or smaller than the values in
+/// `[first2, last2)` with the Mann-Whitney U test (a.k.a. the Wilcoxon rank-sum test). Unlike a t-test,
+/// it doesn't assume normally distributed values, which timing samples rarely are. Uses the normal
+/// approximation with tie and continuity correction, which is reasonable from about 8 values per range.
+template <typename FwdIt1, typename FwdIt2>
+mann_whitney_result mann_whitney_u(FwdIt1 first1, FwdIt1 last1, FwdIt2 first2, FwdIt2 last2)
+{
+    std::vector<std::pair<double, bool>> values; // value, is from the first range
+
+    for (; first1 != last1; ++first1)
+        values.emplace_back(static_cast<double>(*first1), true);
+
+    const auto n1 = static_cast<double>(values.size());
+
+    for (; first2 != last2; ++first2)
+        values.emplace_back(static_cast<double>(*first2), false);
+
+    const auto n  = static_cast<double>(values.size());
+    const auto n2 = n - n1;
+
+    if (n1 == 0 || n2 == 0)
+        return {};
+
+    std::sort(values.begin(), values.end());
+
+    double rank_sum1 = 0;
+    double tie_sum = 0;
+
+    for (size_t i = 0; i < values.size();)
+    {
+        size_t j = i;
+        while (j < values.size() && values[j].first == values[i].first)
+            ++j;
+
+        const double ties = static_cast<double>(j - i);
+        const double average_rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2;
+
+        for (size_t k = i; k < j; ++k)
+            if (values[k].second)
+                rank_sum1 += average_rank;
+
+        tie_sum += ties * ties * ties - ties;
+        i = j;
+    }
+
+    mann_whitney_result result;
+    result.u = rank_sum1 - n1 * (n1 + 1) / 2;
+
+    const double mean = n1 * n2 / 2;
+    const double sigma = std::sqrt(n1 * n2 / 12 * ((n + 1) - tie_sum / (n * (n - 1))));
+
+    if (sigma == 0)
+        return result;
+
+    const double difference = result.u - mean;
+    const double continuity = difference > 0 ? -0.5 : (difference < 0 ? 0.5 : 0.0);
+
+    result.z       = (difference + continuity) / sigma;
+    result.p_value = std::erfc(std::abs(result.z) / std::sqrt(2.0));
+
+    return result;
+}
+
+struct confidence_interval final
+{
+    double low{};
+    double high{};
+};
+
+/// Estimates a `confidence` (like 0.95) interval of the median of the values in `[first, last)` with
+/// the percentile bootstrap: the median of `resamples` random resamples with replacement, and the
+/// interval between the (1 - `confidence`) / 2 and (1 + `confidence`) / 2 quantiles of those medians.
+/// Doesn't assume any distribution of the values. Deterministic for a given `seed`.
+template <typename FwdIt>
+confidence_interval bootstrap_median_interval(FwdIt first, FwdIt last, double confidence = 0.95, size_t resamples = 2000, uint64_t seed = 1)
+{
+    jg::verify(confidence > 0 && confidence < 1);
+    jg::verify(resamples > 0);
+
+    std::vector<double> values;
+
+    for (; first != last; ++first)
+        values.push_back(static_cast<double>(*first));
+
+    if (values.empty())
+        return {};
+
+    std::mt19937_64 engine{seed};
+    std::uniform_int_distribution<size_t> index{0, values.size() - 1};
+    std::vector<double> resample(values.size());
+    std::vector<double> medians;
+    medians.reserve(resamples);
+
+    for (size_t i = 0; i < resamples; ++i)
+    {
+        for (auto& value : resample)
+            value = values[index(engine)];
+
+        medians.push_back(jg::median(resample.begin(), resample.end()));
+    }
+
+    std::sort(medians.begin(), medians.end());
+
+    auto quantile = [&medians] (double q) {
+        return medians[std::min(medians.size() - 1, static_cast<size_t>(q * static_cast<double>(medians.size())))];
+    };
+
+    return {quantile((1 - confidence) / 2), quantile((1 + confidence) / 2)};
+}
+
 } // namespace jg
@@ -0,0 +1,160 @@
+#ifdef JG_ALLOCATION_COUNTER_IMPL
+#undef JG_ALLOCATION_COUNTER_INCLUDED
+#endif
+
+#ifndef JG_ALLOCATION_COUNTER_INCLUDED
+#define JG_ALLOCATION_COUNTER_INCLUDED
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+/// @file Counting of heap allocations made through the global `operator new` and `operator delete`.
+/// @note The counting is opt-in. One translation unit in the program must define JG_ALLOCATION_COUNTER_IMPL
+/// before including this header, which replaces the global `operator new` and `operator delete` with
+/// versions that count. If no translation unit defines it, `allocation_counter::available()` returns false.
+/// @note The replacements only count when an `allocation_counter` has been started on the calling thread,
+/// so the cost in other code is a check of a thread local pointer. The over-aligned (`std::align_val_t`)
+/// overloads aren't replaced and their allocations aren't counted.
+
+namespace jg {
+
+struct allocation_counts final
+{
+    uint64_t allocations{};
+    uint64_t bytes{};          // Requested bytes.
+    int64_t live_bytes{};      // Usable bytes allocated minus freed since start. Negative if more was freed.
+    int64_t peak_live_bytes{}; // Highest `live_bytes` since start.
+};
+
+} // namespace jg
+
+namespace jg::detail {
+
+inline bool allocation_hooks_installed = false;
+inline thread_local allocation_counts* current_allocation_counts = nullptr;
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// Counts the allocations made by the calling thread between `start()` and `stop()`.
+///
+/// @example
+///     jg::allocation_counter counter;
+///     counter.start();
+///     auto string = jg::join(first, last, ", ");
+///     const auto counts = counter.stop();
+///     std::cout << counts.allocations << " allocations\n";
+class allocation_counter final
+{
+public:
+    bool available() const noexcept { return detail::allocation_hooks_installed; }
+
+    void start() noexcept
+    {
+        m_counts = {};
+        m_previous = detail::current_allocation_counts;
+        detail::current_allocation_counts = &m_counts;
+    }
+
+    allocation_counts stop() noexcept
+    {
+        detail::current_allocation_counts = m_previous;
+        return m_counts;
+    }
+
+private:
+    allocation_counts m_counts;
+    allocation_counts* m_previous{};
+};
+
+} // namespace jg
+
+#ifdef JG_ALLOCATION_COUNTER_IMPL
+#undef JG_ALLOCATION_COUNTER_IMPL
+
+#include <cstdlib>
+#include <new>
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace {
+
+[[maybe_unused]] const bool hooks_installed = (jg::detail::allocation_hooks_installed = true);
+
+size_t usable_size(void* ptr) noexcept
+{
+#if defined(_WIN32)
+    return _msize(ptr);
+#elif defined(__APPLE__)
+    return malloc_size(ptr);
+#else
+    return malloc_usable_size(ptr);
+#endif
+}
+
+void* counted_malloc(size_t size) noexcept
+{
+    void* ptr = std::malloc(size > 0 ? size : 1);
+
+    if (auto* counts = jg::detail::current_allocation_counts; counts && ptr)
+    {
+        counts->allocations++;
+        counts->bytes += size;
+        counts->live_bytes += static_cast<int64_t>(usable_size(ptr));
+        counts->peak_live_bytes = std::max(counts->peak_live_bytes, counts->live_bytes);
+    }
+
+    return ptr;
+}
+
+void counted_free(void* ptr) noexcept
+{
+    if (auto* counts = jg::detail::current_allocation_counts; counts && ptr)
+        counts->live_bytes -= static_cast<int64_t>(usable_size(ptr));
+
+    std::free(ptr);
+}
+
+void* counted_new(size_t size)
+{
+    for (;;)
+    {
+        if (void* ptr = counted_malloc(size))
+            return ptr;
+
+        if (auto handler = std::get_new_handler())
+            handler();
+        else
+            throw std::bad_alloc();
+    }
+}
+
+void* counted_new_nothrow(size_t size) noexcept
+{
+    try { return counted_new(size); }
+    catch (...) { return nullptr; }
+}
+
+} // namespace
+
+void* operator new(size_t size) { return counted_new(size); }
+void* operator new[](size_t size) { return counted_new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_new_nothrow(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_new_nothrow(size); }
+
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+
+#endif // #ifdef JG_ALLOCATION_COUNTER_IMPL
+#endif // #ifndef JG_ALLOCATION_COUNTER_INCLUDED
@@ -1,11 +1,67 @@
 #pragma once
 
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "jg_algorithm.h"
+#include "jg_allocation_counter.h"
+#include "jg_cache.h"
+#include "jg_cycle_clock.h"
+#include "jg_histogram.h"
+#include "jg_perf_counters.h"
+#include "jg_stats_accumulator.h"
 #include "jg_stopwatch.h"
 #include "jg_verify.h"
 
 namespace jg {
 
+struct benchmark_options final
+{
+    size_t sample_count{10};
+    size_t func_internal_count{1};
+    bool perf_counters{};                // Counts hardware events around each sample, when permitted.
+    std::chrono::nanoseconds min_time{}; // Keeps sampling after `sample_count` samples until this much time is measured, for at most 10 times as long wall time.
+    bool retain_samples{true};           // Stores every sample in the result. If not, the statistics are streamed, in constant memory.
+    bool count_allocations{};            // Counts heap allocations, if JG_ALLOCATION_COUNTER_IMPL is defined by the program.
+    size_t items_per_iteration{};        // Items processed by one iteration of `func`, for `items_per_second`. 0 if not reported.
+    size_t bytes_per_iteration{};        // Bytes processed by one iteration of `func`, for `bytes_per_second`. 0 if not reported.
+    bool cycle_timing{};                 // Times with `jg::cycle_clock` minus its overhead, for operations below ~100 ns.
+    std::function<void()> setup{};       // Called before each sample, outside of the timing. Not used by `benchmark_threads`.
+    std::function<void()> teardown{};    // Called after each sample, outside of the timing. Not used by `benchmark_threads`.
+    bool cold_cache{};                   // Evicts the CPU caches before each sample, after `setup`. Not used by `benchmark_threads`.
+};
+
+/// Per-iteration heap allocation statistics.
+struct allocation_stats final
+{
+    double allocations{};
+    double bytes{};
+    int64_t peak_live_bytes{}; // Highest live heap bytes in any sample, allocated during the sample.
+};
+
+/// Resource usage of the child process that a benchmark ran isolated in, from `getrusage()`.
+struct process_stats final
+{
+    int64_t max_rss_bytes{};     // Peak resident set size of the child, including what it shared with its parent at the fork.
+    int64_t minor_page_faults{}; // Faults served without I/O, like first touches of new or copy-on-write pages.
+    int64_t major_page_faults{}; // Faults that needed I/O.
+};
+
+/// Per-iteration `jg::cycle_clock` statistics, with the timer overhead subtracted.
+struct cycle_stats final
+{
+    double median{};
+    double average{};
+    double ns_per_cycle{};   // The calibration that the nanosecond statistics were converted with.
+    double timer_overhead{}; // Cycles subtracted from each sample.
+};
+
 struct benchmark_result final
 {
     using sample_type = std::chrono::nanoseconds::rep;
@@ -16,31 +72,717 @@ struct benchmark_result final
     sample_type median{};
     sample_type std_deviation{};
     sample_type median_abs_deviation{};
+    sample_type p90{};  // The percentiles are read from a histogram, with a relative error below 1%.
+    sample_type p99{};
+    sample_type p999{};
+    sample_type max{};
+    std::optional<perf_counter_stats> perf_counters; // Empty if not enabled, not permitted or not scheduled by the PMU.
+    std::optional<allocation_stats> allocations;     // Empty if not enabled or not available.
+    std::optional<double> items_per_second;          // Over the total measured time. Empty if `items_per_iteration` is 0.
+    std::optional<double> bytes_per_second;          // Over the total measured time. Empty if `bytes_per_iteration` is 0.
+    std::optional<cycle_stats> cycles;               // Empty if `cycle_timing` isn't enabled.
+    std::optional<process_stats> process;            // Empty if not run isolated in a child process.
 };
 
+} // namespace jg
+
+namespace jg::detail {
+
+inline void record(jg::histogram& histogram, benchmark_result::sample_type sample)
+{
+    histogram.record(static_cast<uint64_t>(std::max<benchmark_result::sample_type>(sample, 0)));
+}
+
+inline uint64_t median_absolute_deviation(const jg::histogram& histogram, uint64_t median)
+{
+    std::vector<std::pair<uint64_t, uint64_t>> deviations; // deviation, count
+
+    histogram.for_each_bucket([&] (uint64_t value, uint64_t count) {
+        deviations.emplace_back(jg::abs_diff(value, median), count);
+    });
+
+    std::sort(deviations.begin(), deviations.end());
+
+    uint64_t seen = 0;
+
+    for (const auto& [deviation, count] : deviations)
+        if ((seen += count) > histogram.count() / 2)
+            return deviation;
+
+    return 0;
+}
+
+/// Computes the statistics of `result` from its samples, if retained, and otherwise from `histogram`,
+/// which must hold the same samples. The percentiles always come from `histogram`. If the samples aren't
+/// retained, the average and standard deviation come from `moments`, if given, which must also hold the
+/// same samples, since the standard deviation of the histogram buckets is only approximate.
+inline void update_statistics(benchmark_result& result, const jg::histogram& histogram, const jg::stats_accumulator* moments = nullptr)
+{
+    using sample_type = benchmark_result::sample_type;
+
+    if (!result.samples.empty())
+    {
+        // Selects in a copy, so that the reported samples stay in the order they were measured in.
+        std::vector<sample_type> scratch(result.samples.size());
+        const auto median = jg::median_and_deviation(result.samples.begin(), result.samples.end(), jg::span<sample_type>{scratch.data(), scratch.size()});
+
+        result.average              = jg::average(result.samples.begin(), result.samples.end());
+        result.median               = median.median;
+        result.std_deviation        = jg::standard_deviation(result.samples.begin(), result.samples.end(), result.average);
+        result.median_abs_deviation = median.median_abs_deviation;
+    }
+    else if (!histogram.empty())
+    {
+        result.average              = static_cast<sample_type>(std::llround(moments ? moments->mean() : histogram.mean()));
+        result.median               = static_cast<sample_type>(histogram.value_at_percentile(50));
+        result.std_deviation        = static_cast<sample_type>(std::llround(moments ? moments->std_deviation() : histogram.std_deviation()));
+        result.median_abs_deviation = static_cast<sample_type>(median_absolute_deviation(histogram, histogram.value_at_percentile(50)));
+    }
+
+    result.p90  = static_cast<sample_type>(histogram.value_at_percentile(90));
+    result.p99  = static_cast<sample_type>(histogram.value_at_percentile(99));
+    result.p999 = static_cast<sample_type>(histogram.value_at_percentile(99.9));
+    result.max  = static_cast<sample_type>(histogram.max());
+}
+
+/// Sets the throughput of `result` from the items and bytes per iteration in `options`, given that
+/// `iterations` iterations took `measured` in total.
+inline void update_throughput(benchmark_result& result, const benchmark_options& options, size_t iterations, std::chrono::nanoseconds measured)
+{
+    if (measured.count() <= 0)
+        return;
+
+    const double seconds = std::chrono::duration<double>{measured}.count();
+
+    if (options.items_per_iteration > 0)
+        result.items_per_second = static_cast<double>(options.items_per_iteration) * static_cast<double>(iterations) / seconds;
+
+    if (options.bytes_per_iteration > 0)
+        result.bytes_per_second = static_cast<double>(options.bytes_per_iteration) * static_cast<double>(iterations) / seconds;
+}
+
+/// The evictor that `benchmark_options::cold_cache` uses, with its buffer allocated on first use.
+inline jg::cache_evictor& benchmark_cache_evictor()
+{
+    static jg::cache_evictor evictor;
+    return evictor;
+}
+
+/// How many times `benchmark_options::min_time` of wall time `benchmark()` samples at most, to reach `min_time`.
+constexpr int min_time_wall_factor = 10;
+
+/// Accumulates the timed parts of a sample, in `jg::cycle_clock` cycles minus the timer overhead of each
+/// part, or in nanoseconds.
+class sample_timer final
+{
+public:
+    explicit sample_timer(bool cycle_timing)
+        : m_cycle_timing{cycle_timing}
+        , m_timer_overhead{cycle_timing ? jg::cycle_clock_overhead() : 0}
+    {}
+
+    void start() noexcept
+    {
+        if (m_running)
+            return;
+
+        m_running = true;
+
+        if (m_cycle_timing)
+            m_start_cycles = jg::cycle_clock::start();
+        else
+            m_stopwatch = {};
+    }
+
+    void stop() noexcept
+    {
+        if (!m_running)
+            return;
+
+        if (m_cycle_timing)
+        {
+            const auto cycles = jg::cycle_clock::stop() - m_start_cycles;
+            m_elapsed += cycles > m_timer_overhead ? cycles - m_timer_overhead : 0;
+        }
+        else
+            m_elapsed += static_cast<uint64_t>(std::max<std::chrono::nanoseconds::rep>(m_stopwatch.ns(), 0));
+
+        m_running = false;
+    }
+
+    uint64_t timer_overhead() const noexcept { return m_timer_overhead; }
+
+    /// Returns the accumulated cycles or nanoseconds, and restarts the accumulation from 0.
+    uint64_t take_elapsed() noexcept { return std::exchange(m_elapsed, 0); }
+
+private:
+    const bool m_cycle_timing;
+    const uint64_t m_timer_overhead;
+    bool m_running{};
+    uint64_t m_start_cycles{};
+    jg::stopwatch m_stopwatch;
+    uint64_t m_elapsed{};
+};
+
+/// Releases a fixed number of threads together. Spins instead of blocking on a condition variable, so
+/// that the released threads start as close in time as possible.
+class spin_barrier final
+{
+public:
+    explicit spin_barrier(size_t count) noexcept
+        : m_count{count}
+    {}
+
+    void arrive_and_wait() noexcept
+    {
+        const size_t generation = m_generation.load(std::memory_order_acquire);
+
+        if (m_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count)
+        {
+            m_waiting.store(0, std::memory_order_relaxed);
+            m_generation.fetch_add(1, std::memory_order_release);
+            return;
+        }
+
+        while (m_generation.load(std::memory_order_acquire) == generation)
+            std::this_thread::yield();
+    }
+
+private:
+    const size_t m_count;
+    std::atomic<size_t> m_waiting{0};
+    std::atomic<size_t> m_generation{0};
+};
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// Passed to a benchmarked function that takes a `benchmark_state&`, for excluding parts of each sample,
+/// like preparing input, from the timing. The resumed parts are timed separately, so in `cycle_timing`
+/// mode the timer overhead is subtracted once per part.
+/// @note Perf counters and allocation counts still include the paused parts.
+///
+/// @example
+///     jg::benchmark("jg::median", {}, [&] (jg::benchmark_state& state) {
+///         state.pause_timing();
+///         std::shuffle(data.begin(), data.end(), engine);
+///         state.resume_timing();
+///         sink = jg::median(data.begin(), data.end());
+///     });
+class benchmark_state final
+{
+public:
+    explicit benchmark_state(detail::sample_timer& timer) noexcept
+        : m_timer{timer}
+    {}
+
+    void pause_timing() noexcept { m_timer.stop(); }
+    void resume_timing() noexcept { m_timer.start(); }
+
+private:
+    detail::sample_timer& m_timer;
+};
+
+/// Calls `func` `options.sample_count` times, or more if needed for `options.min_time`, and times each
+/// call as a sample. `func` is either parameterless or takes a `benchmark_state&`.
 template <typename Func>
-benchmark_result benchmark(std::string_view description, size_t sample_count, size_t func_internal_count, Func&& func)
+benchmark_result benchmark(std::string_view description, const benchmark_options& options, Func&& func)
 {
-    jg::verify(sample_count > 0);
-    jg::verify(func_internal_count > 0);
+    jg::verify(options.sample_count > 0);
+    jg::verify(options.func_internal_count > 0);
 
     benchmark_result result;
     result.description = description;
-    result.samples.reserve(sample_count);
 
-    for (size_t sample = 0; sample < sample_count; ++sample)
+    if (options.retain_samples)
+        result.samples.reserve(options.sample_count);
+
+    jg::histogram histogram;
+    jg::stats_accumulator moments;
+    std::optional<jg::perf_counters> counters;
+    perf_counter_values counter_values;
+
+    if (options.perf_counters)
+        counters.emplace();
+
+    const bool counting = counters && counters->available();
+
+    jg::allocation_counter allocation_counter;
+    allocation_counts allocation_totals;
+    const bool counting_allocations = options.count_allocations && allocation_counter.available();
+
+    const double ns_per_cycle = options.cycle_timing ? jg::cycle_clock_ns_per_cycle() : 0.0;
+    jg::histogram cycle_histogram;
+
+    detail::sample_timer timer{options.cycle_timing};
+    benchmark_state state{timer};
+
+    std::chrono::nanoseconds measured{};
+
+    // Samples that measure (close to) nothing, like a fully paused `func`, or an empty one whose cycles
+    // are all subtracted as timer overhead, would otherwise never reach `min_time`.
+    const auto max_wall_time = options.min_time * detail::min_time_wall_factor;
+    const jg::stopwatch wall;
+
+    for (size_t sample = 0; sample < options.sample_count || (measured < options.min_time && std::chrono::nanoseconds{wall.ns()} < max_wall_time); ++sample)
+    {
+        if (options.setup)
+            options.setup();
+
+        if (options.cold_cache)
+            detail::benchmark_cache_evictor().evict();
+
+        if (counting)
+            counters->start();
+
+        if (counting_allocations)
+            allocation_counter.start();
+
+        timer.start();
+
+        if constexpr (std::is_invocable_v<Func&, benchmark_state&>)
+            func(state);
+        else
+            func();
+
+        timer.stop();
+
+        const auto elapsed = timer.take_elapsed();
+        benchmark_result::sample_type ns;
+
+        if (options.cycle_timing)
+        {
+            cycle_histogram.record(elapsed);
+            ns = static_cast<benchmark_result::sample_type>(std::llround(static_cast<double>(elapsed) * ns_per_cycle));
+        }
+        else
+            ns = static_cast<benchmark_result::sample_type>(elapsed);
+
+        if (counting_allocations)
+        {
+            const auto counts = allocation_counter.stop();
+            allocation_totals.allocations += counts.allocations;
+            allocation_totals.bytes += counts.bytes;
+            allocation_totals.peak_live_bytes = std::max(allocation_totals.peak_live_bytes, counts.peak_live_bytes);
+        }
+
+        if (counting)
+            counter_values += counters->stop();
+
+        if (options.teardown)
+            options.teardown();
+
+        const auto sample_ns = ns / static_cast<benchmark_result::sample_type>(options.func_internal_count);
+        detail::record(histogram, sample_ns);
+        measured += std::chrono::nanoseconds{ns};
+
+        if (options.retain_samples)
+            result.samples.push_back(sample_ns);
+        else
+            moments.add(static_cast<double>(sample_ns));
+    }
+
+    detail::update_statistics(result, histogram, &moments);
+    detail::update_throughput(result, options, histogram.count() * options.func_internal_count, measured);
+
+    // Counts of unscheduled events are 0, which would look like real counts.
+    if (counting && !counter_values.unscheduled)
+        result.perf_counters = make_perf_counter_stats(counter_values, histogram.count() * options.func_internal_count);
+
+    if (options.cycle_timing)
     {
-        jg::stopwatch sw;
-        func();
-        result.samples.push_back(sw.ns() / func_internal_count);
+        const auto func_internal_count = static_cast<double>(options.func_internal_count);
+        result.cycles = cycle_stats{static_cast<double>(cycle_histogram.value_at_percentile(50)) / func_internal_count,
+                                    cycle_histogram.mean() / func_internal_count,
+                                    ns_per_cycle,
+                                    static_cast<double>(timer.timer_overhead())};
     }
 
-    result.average              = jg::average(result.samples.begin(), result.samples.end());
-    result.median               = jg::median(result.samples.begin(), result.samples.end());
-    result.std_deviation        = jg::standard_deviation(result.samples.begin(), result.samples.end(), result.average);
-    result.median_abs_deviation = jg::median_absolute_deviation(result.samples.begin(), result.samples.end(), result.median);
+    if (counting_allocations)
+    {
+        const auto iterations = static_cast<double>(histogram.count() * options.func_internal_count);
+        result.allocations = allocation_stats{static_cast<double>(allocation_totals.allocations) / iterations,
+                                              static_cast<double>(allocation_totals.bytes) / iterations,
+                                              allocation_totals.peak_live_bytes};
+    }
 
     return result;
 }
 
+template <typename Func>
+benchmark_result benchmark(std::string_view description, size_t sample_count, size_t func_internal_count, Func&& func)
+{
+    return jg::benchmark(description, benchmark_options{sample_count, func_internal_count}, std::forward<Func>(func));
+}
+
+struct benchmark_ab_result final
+{
+    benchmark_result a;
+    benchmark_result b;
+    std::vector<double> ratios;       // Per pair of samples, the time of A divided by the time of B, which is the speedup of B.
+    double median_ratio{};            // The median speedup of B over A. Above 1 if B is faster.
+    confidence_interval speedup;      // Bootstrap confidence interval of `median_ratio`.
+    double confidence{};
+};
+
+/// Compares `func_a` and `func_b` by alternating their samples: A B, B A, A B, ... so that thermal and
+/// frequency drift, and the order within a pair, affect both equally. Each pair of samples gives a ratio
+/// of the per-iteration times, and the median ratio, with a bootstrapped `confidence` interval, is the
+/// speedup of B over A. The speedup is significant if the interval doesn't include 1.
+///
+/// Each function has its own `setup`, `teardown`, `func_internal_count` and `cold_cache` in `options_a`
+/// and `options_b`. The pairing, `sample_count` pairs or more for `min_time`, `cycle_timing` and
+/// `retain_samples`, is taken from `options_a`. `func_a` and `func_b` are either parameterless or take a
+/// `benchmark_state&`. Pairs where either sample is 0 ns are left out of the ratios, so use `cycle_timing`
+/// or a `func_internal_count` loop for very short operations.
+/// @note Perf counters and allocation counting aren't supported, and are ignored.
+///
+/// @example
+///     jg::benchmark_options sort_options{100};
+///     sort_options.setup = [&] { shuffle(data); };
+///     auto ab = jg::benchmark_ab("std::sort", [&] { ... }, sort_options, "pdq_sort", [&] { ... }, sort_options);
+///     jg::write_ab_comparison(std::cout, ab);
+template <typename FuncA, typename FuncB>
+benchmark_ab_result benchmark_ab(std::string_view description_a, FuncA&& func_a, const benchmark_options& options_a,
+                                 std::string_view description_b, FuncB&& func_b, const benchmark_options& options_b,
+                                 double confidence = 0.95)
+{
+    jg::verify(options_a.sample_count > 0);
+    jg::verify(options_a.func_internal_count > 0);
+    jg::verify(options_b.func_internal_count > 0);
+
+    const auto& options = options_a;
+
+    benchmark_ab_result ab;
+    ab.a.description = description_a;
+    ab.b.description = description_b;
+    ab.confidence = confidence;
+
+    if (options.retain_samples)
+    {
+        ab.a.samples.reserve(options.sample_count);
+        ab.b.samples.reserve(options.sample_count);
+    }
+
+    const double ns_per_cycle = options.cycle_timing ? jg::cycle_clock_ns_per_cycle() : 0.0;
+    detail::sample_timer timer{options.cycle_timing};
+    benchmark_state state{timer};
+    jg::histogram histogram_a;
+    jg::histogram histogram_b;
+    jg::stats_accumulator moments_a;
+    jg::stats_accumulator moments_b;
+    std::chrono::nanoseconds measured{};
+
+    // Returns the time per iteration, unrounded for the ratio.
+    auto run_sample = [&] (auto& func, const benchmark_options& func_options, benchmark_result& result, jg::histogram& histogram,
+                           jg::stats_accumulator& moments)
+    {
+        if (func_options.setup)
+            func_options.setup();
+
+        if (func_options.cold_cache)
+            detail::benchmark_cache_evictor().evict();
+
+        timer.start();
+
+        if constexpr (std::is_invocable_v<decltype(func), benchmark_state&>)
+            func(state);
+        else
+            func();
+
+        timer.stop();
+
+        const auto elapsed = timer.take_elapsed();
+        const auto ns = options.cycle_timing ? static_cast<benchmark_result::sample_type>(std::llround(static_cast<double>(elapsed) * ns_per_cycle))
+                                             : static_cast<benchmark_result::sample_type>(elapsed);
+
+        if (func_options.teardown)
+            func_options.teardown();
+
+        const auto sample_ns = ns / static_cast<benchmark_result::sample_type>(func_options.func_internal_count);
+        detail::record(histogram, sample_ns);
+        measured += std::chrono::nanoseconds{ns};
+
+        if (options.retain_samples)
+            result.samples.push_back(sample_ns);
+        else
+            moments.add(static_cast<double>(sample_ns));
+
+        return static_cast<double>(ns) / static_cast<double>(func_options.func_internal_count);
+    };
+
+    // The same cap as in `benchmark()`, for pairs that measure (close to) nothing.
+    const auto max_wall_time = options.min_time * detail::min_time_wall_factor;
+    const jg::stopwatch wall;
+
+    for (size_t pair = 0; pair < options.sample_count || (measured < options.min_time && std::chrono::nanoseconds{wall.ns()} < max_wall_time); ++pair)
+    {
+        double ns_a;
+        double ns_b;
+
+        if (pair % 2 == 0)
+        {
+            ns_a = run_sample(func_a, options_a, ab.a, histogram_a, moments_a);
+            ns_b = run_sample(func_b, options_b, ab.b, histogram_b, moments_b);
+        }
+        else
+        {
+            ns_b = run_sample(func_b, options_b, ab.b, histogram_b, moments_b);
+            ns_a = run_sample(func_a, options_a, ab.a, histogram_a, moments_a);
+        }
+
+        if (ns_a > 0 && ns_b > 0)
+            ab.ratios.push_back(ns_a / ns_b);
+    }
+
+    detail::update_statistics(ab.a, histogram_a, &moments_a);
+    detail::update_statistics(ab.b, histogram_b, &moments_b);
+
+    if (!ab.ratios.empty())
+    {
+        std::vector<double> ratios = ab.ratios;
+        ab.median_ratio = jg::median(ratios.begin(), ratios.end());
+        ab.speedup = jg::bootstrap_median_interval(ab.ratios.begin(), ab.ratios.end(), confidence);
+    }
+
+    return ab;
+}
+
+/// Same as above, with the same `options` for both functions.
+///
+/// @example
+///     auto ab = jg::benchmark_ab("std::sort", [&] { ... }, "pdq_sort", [&] { ... }, {100});
+///     jg::write_ab_comparison(std::cout, ab);
+template <typename FuncA, typename FuncB>
+benchmark_ab_result benchmark_ab(std::string_view description_a, FuncA&& func_a, std::string_view description_b, FuncB&& func_b,
+                                 const benchmark_options& options, double confidence = 0.95)
+{
+    return jg::benchmark_ab(description_a, std::forward<FuncA>(func_a), options, description_b, std::forward<FuncB>(func_b), options, confidence);
+}
+
+/// Makes the geometric sequence of sizes `first`, `first * multiplier`, ... up to and including `last`.
+/// `last` is always included, so `benchmark_sizes(1, 1 << 20)` gives 1, 8, 64, ..., 262144, 1048576.
+inline std::vector<size_t> benchmark_sizes(size_t first, size_t last, size_t multiplier = 8)
+{
+    jg::verify(first > 0);
+    jg::verify(first <= last);
+    jg::verify(multiplier > 1);
+
+    std::vector<size_t> sizes;
+
+    for (size_t size = first; size < last; size *= multiplier)
+        sizes.push_back(size);
+
+    sizes.push_back(last);
+
+    return sizes;
+}
+
+struct benchmark_range_result final
+{
+    std::vector<size_t> sizes;
+    std::vector<benchmark_result> results; // One result per size, described as "description/size".
+    complexity_fit fit;                    // Best fit of the result medians.
+};
+
+/// Benchmarks `func(size)` for each size in `sizes`, and fits the medians to the complexity classes
+/// in `jg::complexity`. Catches accidental quadratic behavior when data sizes grow.
+///
+/// `options.items_per_iteration` and `options.bytes_per_iteration` are per unit of size, so that the
+/// throughput of each size is comparable. For instance 1 item per iteration when `func(size)` processes
+/// `size` elements.
+///
+/// `func` takes the size, and optionally a `benchmark_state&` after it.
+///
+/// @example
+///     auto range = jg::benchmark_range("std::sort", {}, jg::benchmark_sizes(1, 1 << 20), [&] (size_t n) {
+///         std::sort(data.begin(), data.begin() + n);
+///     });
+///     std::cout << jg::to_string(range.fit.complexity) << ", rms " << range.fit.rms << '\n';
+template <typename Func>
+benchmark_range_result benchmark_range(std::string_view description, const benchmark_options& options, std::vector<size_t> sizes, Func&& func)
+{
+    jg::verify(sizes.size() > 1);
+
+    benchmark_range_result range;
+    range.results.reserve(sizes.size());
+
+    for (const size_t size : sizes)
+    {
+        auto size_options = options;
+        size_options.items_per_iteration *= size;
+        size_options.bytes_per_iteration *= size;
+
+        range.results.push_back(jg::benchmark(std::string{description} + '/' + std::to_string(size), size_options, [&] (benchmark_state& state) {
+            if constexpr (std::is_invocable_v<Func&, size_t, benchmark_state&>)
+                func(size, state);
+            else
+                func(size);
+        }));
+    }
+
+    std::vector<benchmark_result::sample_type> medians;
+    medians.reserve(range.results.size());
+
+    for (const auto& result : range.results)
+        medians.push_back(result.median);
+
+    range.fit   = jg::fit_complexity(sizes.begin(), sizes.end(), medians.begin());
+    range.sizes = std::move(sizes);
+
+    return range;
+}
+
+/// Makes the thread counts 1, 2, 4 ... up to and including `max_thread_count`.
+inline std::vector<size_t> benchmark_thread_counts(size_t max_thread_count = std::thread::hardware_concurrency())
+{
+    return max_thread_count > 1 ? benchmark_sizes(1, max_thread_count, 2) : std::vector<size_t>{1};
+}
+
+struct benchmark_threads_result final
+{
+    size_t thread_count{};
+    std::vector<benchmark_result> threads; // Per-thread latency, described as "description/threads:N/thread:I".
+    benchmark_result latency;              // All per-thread samples pooled, described as "description/threads:N".
+    double throughput{};                   // Iterations per second, summed over all threads.
+    double efficiency{};                   // Throughput relative to `thread_count` times the first run's throughput.
+};
+
+struct benchmark_scaling_result final
+{
+    std::string description;
+    std::vector<benchmark_threads_result> runs; // One run per thread count.
+};
+
+/// Runs `func` on each of the `thread_counts` number of threads. In each sample, all threads are released
+/// together by a barrier and time their own call to `func`. `func` is either parameterless or takes the
+/// `size_t` index of the calling thread. Contention in shared state shows as per-thread latency growing,
+/// and as parallel efficiency dropping below 1, with the number of threads.
+///
+/// The throughput is summed over the threads' own measured time, so it excludes the barrier waits.
+/// `options.items_per_iteration` and `options.bytes_per_iteration` give the per-thread and pooled
+/// `items_per_second` and `bytes_per_second` in the same way.
+///
+/// @note Hardware performance counters are per thread, so `options.perf_counters` is ignored.
+/// @note All threads must take the same number of samples, so `options.min_time` must be 0. The heap
+///       allocation counter counts all threads and `jg::cycle_clock` may differ between cores, so
+///       `options.count_allocations` and `options.cycle_timing` must be unset.
+/// @note Efficiency is relative to the first thread count, which should be 1 for it to be meaningful.
+///
+/// @example
+///     auto scaling = jg::benchmark_threads("log_enabled", {1000, 1}, jg::benchmark_thread_counts(), [] {
+///         (void)jg::log_enabled(jg::log_level::info);
+///     });
+template <typename Func>
+benchmark_scaling_result benchmark_threads(std::string_view description, const benchmark_options& options, const std::vector<size_t>& thread_counts, Func&& func)
+{
+    jg::verify(options.sample_count > 0);
+    jg::verify(options.func_internal_count > 0);
+    jg::verify(options.min_time.count() == 0);
+    jg::verify(!options.count_allocations);
+    jg::verify(!options.cycle_timing);
+    jg::verify(!thread_counts.empty());
+
+    benchmark_scaling_result scaling;
+    scaling.description = description;
+    scaling.runs.reserve(thread_counts.size());
+
+    for (const size_t thread_count : thread_counts)
+    {
+        jg::verify(thread_count > 0);
+
+        benchmark_threads_result run;
+        run.thread_count = thread_count;
+        run.threads.resize(thread_count);
+
+        const std::string run_description = std::string{description} + "/threads:" + std::to_string(thread_count);
+        std::vector<jg::histogram> histograms(thread_count);
+        std::vector<jg::stats_accumulator> moments(thread_count);
+        std::vector<benchmark_result::sample_type> measured_ns(thread_count);
+        detail::spin_barrier barrier{thread_count};
+
+        auto thread_func = [&] (size_t thread_index)
+        {
+            auto& samples = run.threads[thread_index].samples;
+            auto& histogram = histograms[thread_index];
+            jg::stats_accumulator thread_moments; // Local, so that the threads don't share its cache line.
+            benchmark_result::sample_type thread_measured_ns{};
+
+            if (options.retain_samples)
+                samples.reserve(options.sample_count);
+
+            for (size_t sample = 0; sample < options.sample_count; ++sample)
+            {
+                barrier.arrive_and_wait();
+                jg::stopwatch sw;
+
+                if constexpr (std::is_invocable_v<Func&, size_t>)
+                    func(thread_index);
+                else
+                    func();
+
+                const auto elapsed_ns = sw.ns();
+                const auto sample_ns = elapsed_ns / static_cast<benchmark_result::sample_type>(options.func_internal_count);
+                thread_measured_ns += elapsed_ns;
+                detail::record(histogram, sample_ns);
+                thread_moments.add(static_cast<double>(sample_ns));
+
+                if (options.retain_samples)
+                    samples.push_back(sample_ns);
+            }
+
+            moments[thread_index] = thread_moments;
+            measured_ns[thread_index] = thread_measured_ns;
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+
+        for (size_t thread_index = 1; thread_index < thread_count; ++thread_index)
+            threads.emplace_back(thread_func, thread_index);
+
+        thread_func(0);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        run.latency.description = run_description;
+        jg::histogram pooled;
+        jg::stats_accumulator pooled_moments;
+        const size_t thread_iterations = options.sample_count * options.func_internal_count;
+
+        for (size_t thread_index = 0; thread_index < thread_count; ++thread_index)
+        {
+            auto& thread_result = run.threads[thread_index];
+            thread_result.description = run_description + "/thread:" + std::to_string(thread_index);
+            run.latency.samples.insert(run.latency.samples.end(), thread_result.samples.begin(), thread_result.samples.end());
+            pooled.merge(histograms[thread_index]);
+            pooled_moments.merge(moments[thread_index]);
+            detail::update_statistics(thread_result, histograms[thread_index], &moments[thread_index]);
+            detail::update_throughput(thread_result, options, thread_iterations, std::chrono::nanoseconds{measured_ns[thread_index]});
+
+            if (measured_ns[thread_index] > 0)
+                run.throughput += static_cast<double>(thread_iterations) * 1e9 / static_cast<double>(measured_ns[thread_index]);
+        }
+
+        detail::update_statistics(run.latency, pooled, &pooled_moments);
+
+        // The threads ran concurrently, so the pooled rates are the sums of the per-thread rates.
+        if (options.items_per_iteration > 0)
+            run.latency.items_per_second = static_cast<double>(options.items_per_iteration) * run.throughput;
+
+        if (options.bytes_per_iteration > 0)
+            run.latency.bytes_per_second = static_cast<double>(options.bytes_per_iteration) * run.throughput;
+
+        const auto& first = scaling.runs.empty() ? run : scaling.runs.front();
+        const double first_throughput_per_thread = first.throughput / static_cast<double>(first.thread_count);
+        run.efficiency = first_throughput_per_thread > 0 ? run.throughput / (first_throughput_per_thread * static_cast<double>(thread_count)) : 0.0;
+
+        scaling.runs.push_back(std::move(run));
+    }
+
+    return scaling;
+}
+
 } // namespace jg
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "jg_cache.h"
+#include "jg_string.h"
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/utsname.h>
+#endif
+
+/// @file Capture of the machine and build that benchmarks run on, warnings about settings that make
+/// benchmark results noisy, and pinning of the benchmarking thread to a CPU.
+
+namespace jg {
+
+struct benchmark_environment final
+{
+    std::string cpu_model;
+    size_t cpu_count{};
+    std::optional<size_t> last_level_cache_size;
+    std::string governor;               // The cpu0 frequency scaling governor. Empty if unknown.
+    std::optional<bool> turbo;          // If frequency boost above base frequency is enabled. Empty if unknown.
+    std::optional<double> load_average; // The one minute load average. Empty if unknown.
+    std::string kernel;
+    std::string compiler;
+    std::string build_flags;            // Flags detected from predefined macros, like "optimized NDEBUG avx2".
+    std::optional<size_t> pinned_cpu;   // The CPU that the benchmarks ran on, if pinned.
+};
+
+} // namespace jg
+
+namespace jg::detail {
+
+inline std::string cpu_model()
+{
+#if defined(__linux__)
+    std::ifstream cpuinfo{"/proc/cpuinfo"};
+
+    for (std::string line; std::getline(cpuinfo, line);)
+    {
+        if (line.compare(0, 10, "model name") != 0 && line.compare(0, 9, "Processor") != 0)
+            continue;
+
+        const auto value = line.find_first_not_of(" \t", line.find(':') + 1);
+        return value == std::string::npos ? std::string{} : line.substr(value);
+    }
+#endif
+    return {};
+}
+
+inline std::string compiler()
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    return {};
+#endif
+}
+
+inline std::string build_flags()
+{
+    std::vector<std::string> flags;
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && !defined(_DEBUG))
+    flags.push_back("optimized");
+#endif
+#if defined(NDEBUG)
+    flags.push_back("NDEBUG");
+#endif
+#if defined(__AVX512F__)
+    flags.push_back("avx512f");
+#endif
+#if defined(__AVX2__)
+    flags.push_back("avx2");
+#endif
+#if defined(__ARM_NEON)
+    flags.push_back("neon");
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+    flags.push_back("asan");
+#endif
+    return jg::join(flags.begin(), flags.end(), " ");
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// Captures the environment of the calling process. Fields that aren't available on the platform are
+/// left empty.
+inline benchmark_environment capture_benchmark_environment()
+{
+    benchmark_environment environment;
+    environment.cpu_model             = detail::cpu_model();
+    environment.cpu_count             = std::thread::hardware_concurrency();
+    environment.last_level_cache_size = jg::last_level_cache_size();
+    environment.compiler              = detail::compiler();
+    environment.build_flags           = detail::build_flags();
+
+#if defined(__linux__)
+    environment.governor = detail::read_first_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+
+    if (const auto no_turbo = detail::read_first_line("/sys/devices/system/cpu/intel_pstate/no_turbo"); !no_turbo.empty())
+        environment.turbo = no_turbo == "0";
+    else if (const auto boost = detail::read_first_line("/sys/devices/system/cpu/cpufreq/boost"); !boost.empty())
+        environment.turbo = boost == "1";
+
+    const auto loadavg = detail::read_first_line("/proc/loadavg");
+    environment.load_average = jg::from_chars<double>(std::string_view{loadavg}.substr(0, loadavg.find(' ')));
+
+    if (utsname name{}; uname(&name) == 0)
+        environment.kernel = std::string{name.sysname} + ' ' + name.release;
+#endif
+
+    return environment;
+}
+
+/// Warnings about settings in `environment` that are known to make benchmark results noisy.
+inline std::vector<std::string> benchmark_environment_warnings(const benchmark_environment& environment)
+{
+    std::vector<std::string> warnings;
+
+    if (!environment.governor.empty() && environment.governor != "performance")
+        warnings.push_back("The CPU frequency governor is '" + environment.governor + "', not 'performance'. Results will vary with the frequency.");
+
+    if (environment.turbo.value_or(false))
+        warnings.push_back("Turbo boost is enabled. Results will vary with temperature and the load on other cores.");
+
+    // A load above the CPU count means that more threads are runnable than there are CPUs to run them.
+    const size_t cpu_count = std::max<size_t>(environment.cpu_count, 1);
+
+    if (environment.load_average.value_or(0) > static_cast<double>(cpu_count))
+    {
+        char load_average[32];
+        std::snprintf(load_average, sizeof(load_average), "%.2f", *environment.load_average);
+        warnings.push_back("The load average is " + std::string{load_average} + " on " + std::to_string(cpu_count) +
+                           (cpu_count == 1 ? " CPU" : " CPUs") + ". Other processes compete for the CPUs.");
+    }
+
+    if (environment.build_flags.find("optimized") == std::string::npos)
+        warnings.push_back("This isn't an optimized build.");
+
+    return warnings;
+}
+
+/// Describes the fields that differ between `baseline` and `current` in ways that make their results
+/// incomparable: the CPU, the CPU count, the kernel, the compiler and the build flags.
+inline std::vector<std::string> benchmark_environment_differences(const benchmark_environment& baseline, const benchmark_environment& current)
+{
+    std::vector<std::string> differences;
+
+    auto compare = [&] (const char* name, const std::string& baseline_value, const std::string& current_value) {
+        if (baseline_value != current_value)
+            differences.push_back(std::string{name} + " '" + baseline_value + "' != '" + current_value + "'");
+    };
+
+    compare("cpu_model", baseline.cpu_model, current.cpu_model);
+    compare("cpu_count", std::to_string(baseline.cpu_count), std::to_string(current.cpu_count));
+    compare("kernel", baseline.kernel, current.kernel);
+    compare("compiler", baseline.compiler, current.compiler);
+    compare("build_flags", baseline.build_flags, current.build_flags);
+
+    return differences;
+}
+
+/// The first CPU that is isolated from the scheduler with the `isolcpus` kernel parameter, which is the
+/// best CPU to pin a benchmark to. Empty if no CPU is isolated, or on other platforms than Linux.
+inline std::optional<size_t> isolated_cpu()
+{
+#if defined(__linux__)
+    // A list like "2-3,6", so the first number is the first isolated CPU.
+    const auto isolated = detail::read_first_line("/sys/devices/system/cpu/isolated");
+    return jg::from_chars<size_t>(isolated);
+#else
+    return std::nullopt;
+#endif
+}
+
+/// Pins the calling thread to `cpu`, so that the scheduler doesn't migrate it between CPUs.
+/// @returns false if pinning failed, or isn't supported on the platform.
+inline bool pin_to_cpu(size_t cpu)
+{
+#if defined(__linux__)
+    if (cpu >= CPU_SETSIZE)
+        return false;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+} // namespace jg
@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "jg_algorithm.h"
+#include "jg_benchmark.h"
+#include "jg_benchmark_environment.h"
+#include "jg_benchmark_report.h"
+
+/// @file A local history of benchmark runs, appended to one file per machine or project, and detection
+/// of trends and step changes over the history.
+
+namespace jg {
+
+struct benchmark_history_record final
+{
+    using sample_type = benchmark_result::sample_type;
+
+    int64_t time{};          // Seconds since the Unix epoch.
+    std::string commit;      // The git commit that was benchmarked. Empty if unknown.
+    std::string environment; // `benchmark_environment_hash()` of the environment that the run was made in.
+    std::string description;
+    sample_type median{};
+    sample_type median_abs_deviation{};
+    sample_type p99{};
+};
+
+/// A hash of the fields of `environment` that make results incomparable, as listed by
+/// `benchmark_environment_differences()`, as 16 hex digits. Records with the same hash are comparable.
+inline std::string benchmark_environment_hash(const benchmark_environment& environment)
+{
+    uint64_t hash = 0xcbf29ce484222325; // FNV-1a
+
+    for (const auto& field : {environment.cpu_model, std::to_string(environment.cpu_count), environment.kernel,
+                              environment.compiler, environment.build_flags})
+    {
+        for (const char c : field + '\n')
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3;
+        }
+    }
+
+    std::ostringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return stream.str();
+}
+
+/// One record per result, all with the same `time`, `commit` and environment hash.
+inline std::vector<benchmark_history_record> benchmark_history_records(const std::vector<benchmark_result>& results,
+                                                                       const std::string& commit,
+                                                                       const benchmark_environment& environment,
+                                                                       int64_t time = static_cast<int64_t>(std::time(nullptr)))
+{
+    std::vector<benchmark_history_record> records;
+    const auto environment_hash = benchmark_environment_hash(environment);
+
+    for (const auto& result : results)
+        records.push_back({time, commit, environment_hash, result.description, result.median, result.median_abs_deviation, result.p99});
+
+    return records;
+}
+
+/// Writes `records` as CSV lines without a header, so that they can be appended to a history file.
+inline void write_benchmark_history(std::ostream& stream, const std::vector<benchmark_history_record>& records)
+{
+    for (const auto& record : records)
+    {
+        stream << record.time << ',';
+        detail::write_csv_string(stream, record.commit);
+        stream << ',' << record.environment << ',';
+        detail::write_csv_string(stream, record.description);
+        stream << ',' << record.median << ',' << record.median_abs_deviation << ',' << record.p99 << '\n';
+    }
+}
+
+/// Reads records written by `write_benchmark_history()`. Empty lines and lines starting with '#' are skipped.
+/// @returns The records in file order, or `std::nullopt` if a line isn't a valid record.
+inline std::optional<std::vector<benchmark_history_record>> read_benchmark_history(std::istream& stream)
+{
+    using sample_type = benchmark_history_record::sample_type;
+
+    std::vector<benchmark_history_record> records;
+
+    for (std::string line; std::getline(stream, line);)
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        const auto fields = detail::csv_fields(line);
+
+        if (fields.size() < 7)
+            return std::nullopt;
+
+        const auto time                 = jg::from_chars<int64_t>(fields[0]);
+        const auto median               = jg::from_chars<sample_type>(fields[4]);
+        const auto median_abs_deviation = jg::from_chars<sample_type>(fields[5]);
+        const auto p99                  = jg::from_chars<sample_type>(fields[6]);
+
+        if (!time || !median || !median_abs_deviation || !p99)
+            return std::nullopt;
+
+        records.push_back({*time, fields[1], fields[2], fields[3], *median, *median_abs_deviation, *p99});
+    }
+
+    return records;
+}
+
+/// Appends `records` to the history file at `path`, which is created with a comment header if it
+/// doesn't exist.
+/// @returns false if the file can't be written.
+inline bool append_benchmark_history(const std::string& path, const std::vector<benchmark_history_record>& records)
+{
+    const bool exists = std::ifstream{path}.good();
+    std::ofstream file{path, std::ios::app};
+
+    if (!file)
+        return false;
+
+    if (!exists)
+        file << "# time,commit,environment,description,median,median_abs_deviation,p99\n";
+
+    write_benchmark_history(file, records);
+    return file.good();
+}
+
+/// The indexes in `values` where the level shifts, found by binary segmentation: each segment is split
+/// where the squared error around the segment means is smallest, if the medians on either side of the
+/// split differ by more than `threshold` (relative) and by more than three times the noise, estimated
+/// as the scaled median absolute deviation within the two sides. Each side has at least `min_segment`
+/// values. A returned index is the first value after the shift.
+inline std::vector<size_t> change_points(const std::vector<double>& values, double threshold = 0.05, size_t min_segment = 3)
+{
+    std::vector<size_t> points;
+
+    if (min_segment == 0 || values.size() < 2 * min_segment)
+        return points;
+
+    std::vector<double> sums{0};
+    std::vector<double> squares{0};
+
+    for (const double value : values)
+    {
+        sums.push_back(sums.back() + value);
+        squares.push_back(squares.back() + value * value);
+    }
+
+    auto squared_error = [&] (size_t first, size_t last) {
+        const double sum = sums[last] - sums[first];
+        return squares[last] - squares[first] - sum * sum / static_cast<double>(last - first);
+    };
+
+    auto median = [&values] (size_t first, size_t last) {
+        std::vector<double> segment(values.begin() + static_cast<ptrdiff_t>(first), values.begin() + static_cast<ptrdiff_t>(last));
+        return jg::median(segment.begin(), segment.end());
+    };
+
+    auto deviations = [&values] (size_t first, size_t last, double median, std::vector<double>& result) {
+        for (size_t i = first; i < last; ++i)
+            result.push_back(std::abs(values[i] - median));
+    };
+
+    std::vector<std::pair<size_t, size_t>> segments{{0, values.size()}};
+
+    while (!segments.empty())
+    {
+        const auto [first, last] = segments.back();
+        segments.pop_back();
+
+        if (last - first < 2 * min_segment)
+            continue;
+
+        size_t split = first + min_segment;
+
+        for (size_t i = split + 1; i <= last - min_segment; ++i)
+            if (squared_error(first, i) + squared_error(i, last) < squared_error(first, split) + squared_error(split, last))
+                split = i;
+
+        const double median_before = median(first, split);
+        const double median_after  = median(split, last);
+
+        std::vector<double> absolute_deviations;
+        deviations(first, split, median_before, absolute_deviations);
+        deviations(split, last, median_after, absolute_deviations);
+        const double noise = 1.4826 * jg::median(absolute_deviations.begin(), absolute_deviations.end());
+
+        const double step = std::abs(median_after - median_before);
+
+        if (step <= threshold * std::abs(median_before) || step <= 3 * noise)
+            continue;
+
+        points.push_back(split);
+        segments.emplace_back(first, split);
+        segments.emplace_back(split, last);
+    }
+
+    std::sort(points.begin(), points.end());
+    return points;
+}
+
+struct benchmark_trend final
+{
+    std::string description;
+    std::string environment;
+    std::vector<benchmark_history_record> runs; // Oldest first.
+    std::vector<size_t> change_points;          // Indexes in `runs` where the median shifts.
+};
+
+/// Groups `records` by description and environment hash, orders each group by time and finds the step
+/// changes of its medians with `change_points()`.
+inline std::vector<benchmark_trend> benchmark_trends(const std::vector<benchmark_history_record>& records,
+                                                     double threshold = 0.05)
+{
+    std::map<std::pair<std::string, std::string>, benchmark_trend> groups;
+    std::vector<std::pair<std::string, std::string>> order;
+
+    for (const auto& record : records)
+    {
+        const std::pair key{record.description, record.environment};
+        auto [group, inserted] = groups.try_emplace(key);
+
+        if (inserted)
+        {
+            group->second.description = record.description;
+            group->second.environment = record.environment;
+            order.push_back(key);
+        }
+
+        group->second.runs.push_back(record);
+    }
+
+    std::vector<benchmark_trend> trends;
+
+    for (const auto& key : order)
+    {
+        auto& trend = groups[key];
+        std::stable_sort(trend.runs.begin(), trend.runs.end(), [] (const auto& r1, const auto& r2) { return r1.time < r2.time; });
+
+        std::vector<double> medians;
+
+        for (const auto& run : trend.runs)
+            medians.push_back(static_cast<double>(run.median));
+
+        trend.change_points = change_points(medians, threshold);
+        trends.push_back(std::move(trend));
+    }
+
+    return trends;
+}
+
+/// Writes one line per trend, with the number of runs and the change of the median from the first to the
+/// last run, followed by one line per step change with the commits on either side of it.
+inline void write_trends(std::ostream& stream, const std::vector<benchmark_trend>& trends)
+{
+    if (trends.empty())
+        return;
+
+    const size_t column1_width = std::max_element(
+        trends.begin(),
+        trends.end(),
+        [](const auto& t1, const auto& t2)
+        { return t1.description.length() < t2.description.length(); })->description.length() + 3;
+
+    const auto flags = stream.flags();
+    const auto precision = stream.precision();
+
+    auto percent = [] (double from, double to) { return from > 0 ? (to / from - 1) * 100 : 0.0; };
+
+    for (const auto& trend : trends)
+    {
+        const auto& first = trend.runs.front();
+        const auto& last  = trend.runs.back();
+
+        stream << std::setw(column1_width) << std::left << trend.description << std::right
+               << std::setw(6) << trend.runs.size() << " runs"
+               << std::setw(14) << first.median << " ns ->"
+               << std::setw(14) << last.median << " ns"
+               << std::setw(10) << std::showpos << std::fixed << std::setprecision(1)
+               << percent(static_cast<double>(first.median), static_cast<double>(last.median)) << '%' << std::noshowpos
+               << "  [" << trend.environment << "]\n";
+
+        for (const auto point : trend.change_points)
+        {
+            const auto& before = trend.runs[point - 1];
+            const auto& after  = trend.runs[point];
+
+            stream << std::setw(column1_width) << "" << "  step " << std::setw(10) << (before.commit.empty() ? "?" : before.commit)
+                   << " -> " << std::setw(10) << std::left << (after.commit.empty() ? "?" : after.commit) << std::right
+                   << std::setw(14) << before.median << " ns ->"
+                   << std::setw(14) << after.median << " ns"
+                   << std::setw(10) << std::showpos
+                   << percent(static_cast<double>(before.median), static_cast<double>(after.median)) << '%' << std::noshowpos << '\n';
+        }
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+/// The short hash of the git commit checked out in the working directory, or an empty string if there
+/// is none or git isn't available.
+inline std::string current_git_commit()
+{
+#if defined(_WIN32)
+    FILE* pipe = _popen("git rev-parse --short HEAD 2>NUL", "r");
+#else
+    FILE* pipe = popen("git rev-parse --short HEAD 2>/dev/null", "r");
+#endif
+
+    if (!pipe)
+        return {};
+
+    std::string commit;
+    char buffer[64];
+
+    while (fgets(buffer, sizeof(buffer), pipe))
+        commit += buffer;
+
+#if defined(_WIN32)
+    const bool succeeded = _pclose(pipe) == 0;
+#else
+    const bool succeeded = pclose(pipe) == 0;
+#endif
+
+    while (!commit.empty() && (commit.back() == '\n' || commit.back() == '\r'))
+        commit.pop_back();
+
+    return succeeded ? commit : std::string{};
+}
+
+} // namespace jg
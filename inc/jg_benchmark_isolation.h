@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cerrno>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "jg_benchmark.h"
+#include "jg_benchmark_report.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/// @file Running benchmarks in forked child processes, so that they don't inherit heap fragmentation,
+/// warmed caches, lazily initialized state or page cache state from the benchmarks before them.
+
+namespace jg {
+
+/// The resource usage of the calling process so far.
+/// @returns `std::nullopt` on other platforms than Linux and macOS.
+inline std::optional<process_stats> current_process_stats()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return std::nullopt;
+
+    process_stats stats;
+#if defined(__APPLE__)
+    stats.max_rss_bytes = static_cast<int64_t>(usage.ru_maxrss);
+#else
+    stats.max_rss_bytes = static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+    stats.minor_page_faults = static_cast<int64_t>(usage.ru_minflt);
+    stats.major_page_faults = static_cast<int64_t>(usage.ru_majflt);
+    return stats;
+#else
+    return std::nullopt;
+#endif
+}
+
+/// Calls `func`, which returns a `std::vector<benchmark_result>`, in a forked child process. The child
+/// writes the results back over a pipe, as JSON, with `process` set to the child's resource usage. On
+/// other platforms than Linux and macOS, `func` is called in the calling process and `process` is empty.
+/// @returns The results, or `std::nullopt` if the child failed, like if it crashed or `func` threw.
+/// @note Only the forking thread exists in the child, so `func` can't rely on other threads of the parent.
+///
+/// @example
+///     auto results = jg::benchmark_isolated([] {
+///         return std::vector{jg::benchmark("parse config", {10, 100}, [] { parse_config(text); })};
+///     });
+template <typename Func>
+std::optional<std::vector<benchmark_result>> benchmark_isolated(Func&& func)
+{
+    static_assert(std::is_same_v<std::invoke_result_t<Func&>, std::vector<benchmark_result>>,
+                  "func must return std::vector<jg::benchmark_result>");
+
+#if defined(__unix__) || defined(__APPLE__)
+    int fds[2];
+
+    if (pipe(fds) != 0)
+        return std::nullopt;
+
+    const pid_t pid = fork();
+
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return std::nullopt;
+    }
+
+    if (pid == 0)
+    {
+        // The child must only leave through `_exit()`. An exception that unwinds out of here would
+        // continue in the caller of the parent, like running the rest of the benchmarks a second time.
+        try
+        {
+            close(fds[0]);
+
+            auto results = func();
+            const auto stats = current_process_stats();
+
+            for (auto& result : results)
+                result.process = stats;
+
+            std::ostringstream stream;
+            write_json(stream, results);
+            const std::string document = stream.str();
+
+            for (size_t written = 0; written < document.size();)
+            {
+                const auto count = write(fds[1], document.data() + written, document.size() - written);
+
+                if (count < 0 && errno == EINTR)
+                    continue;
+
+                if (count <= 0)
+                    _exit(1);
+
+                written += static_cast<size_t>(count);
+            }
+        }
+        catch (...)
+        {
+            _exit(1);
+        }
+
+        // Skips the destructors of the parent's statics and the atexit handlers, which the parent runs.
+        _exit(0);
+    }
+
+    close(fds[1]);
+
+    std::string document;
+    char buffer[4096];
+
+    for (;;)
+    {
+        const auto count = read(fds[0], buffer, sizeof(buffer));
+
+        if (count < 0 && errno == EINTR)
+            continue;
+
+        if (count <= 0)
+            break;
+
+        document.append(buffer, static_cast<size_t>(count));
+    }
+
+    close(fds[0]);
+
+    int status = 0;
+
+    while (waitpid(pid, &status, 0) < 0)
+        if (errno != EINTR)
+            return std::nullopt;
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return std::nullopt;
+
+    std::istringstream stream{document};
+    return read_benchmark_results(stream);
+#else
+    return func();
+#endif
+}
+
+} // namespace jg
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include "jg_benchmark.h"
+#include "jg_histogram.h"
+#include "jg_stats_accumulator.h"
+#include "jg_verify.h"
+
+/// @file Open-loop load generation, for measuring latency at a given throughput.
+
+namespace jg {
+
+struct load_options final
+{
+    double rate{1000};                                           // Target operations per second.
+    std::chrono::nanoseconds duration{std::chrono::seconds{1}};  // How long to generate load, after `warmup`.
+    std::chrono::nanoseconds warmup{};                           // Load generated before the measurement starts.
+    bool retain_samples{};                                       // Stores every latency in the results. If not, the statistics are streamed.
+};
+
+struct load_result final
+{
+    benchmark_result latency;      // From the scheduled start of each operation until it's done, described as "description/latency".
+    benchmark_result service_time; // From the actual start of each operation until it's done, described as "description/service_time".
+    jg::histogram latency_histogram;
+    jg::histogram service_time_histogram;
+    double target_rate{};          // Operations per second.
+    double achieved_rate{};        // Operations per second, lower than `target_rate` if the operations couldn't keep up.
+};
+
+/// Calls `func` at a fixed `options.rate` per second, on a schedule that doesn't depend on how long
+/// `func` takes (open loop), and measures the latency of each call from its scheduled start time. If a
+/// call is late because earlier calls took longer than the interval between them, the time it waited
+/// counts in its latency, as it would for a request waiting in a queue. Timing from the actual start,
+/// like `jg::benchmark` does (closed loop), omits that waiting ("coordinated omission") and is reported
+/// separately as the service time. `func` is either parameterless or takes the `size_t` operation index.
+///
+/// @example
+///     auto load = jg::benchmark_load("log_info", {100'000}, [] { jg::log_info() << "request done\n"; });
+///     std::cout << "p99.9 at 100k/s: " << load.latency.p999 << " ns\n";
+template <typename Func>
+load_result benchmark_load(std::string_view description, const load_options& options, Func&& func)
+{
+    jg::verify(options.rate > 0);
+    jg::verify(options.duration.count() > 0);
+
+    using clock = std::chrono::steady_clock;
+
+    load_result result;
+    result.latency.description = std::string{description} + "/latency";
+    result.service_time.description = std::string{description} + "/service_time";
+    result.target_rate = options.rate;
+
+    const std::chrono::duration<double, std::nano> interval{1e9 / options.rate};
+    const auto start = clock::now();
+    const auto measure_start = start + options.warmup;
+    const auto end = measure_start + options.duration;
+    size_t measured_operations = 0;
+    jg::stats_accumulator latency_moments;
+    jg::stats_accumulator service_time_moments;
+    auto last_done = start;
+
+    for (size_t operation = 0;; ++operation)
+    {
+        const auto scheduled = start + std::chrono::duration_cast<clock::duration>(interval * static_cast<double>(operation));
+
+        if (scheduled >= end)
+            break;
+
+        // Sleeps until close to the scheduled time, then spins for precision.
+        auto now = clock::now();
+
+        if (scheduled - now > std::chrono::microseconds{200})
+            std::this_thread::sleep_for(scheduled - now - std::chrono::microseconds{100});
+
+        while ((now = clock::now()) < scheduled)
+            ;
+
+        if constexpr (std::is_invocable_v<Func&, size_t>)
+            func(operation);
+        else
+            func();
+
+        last_done = clock::now();
+
+        if (scheduled < measure_start)
+            continue;
+
+        const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(last_done - scheduled).count();
+        const auto service_time = std::chrono::duration_cast<std::chrono::nanoseconds>(last_done - now).count();
+
+        detail::record(result.latency_histogram, latency);
+        detail::record(result.service_time_histogram, service_time);
+        ++measured_operations;
+
+        if (options.retain_samples)
+        {
+            result.latency.samples.push_back(latency);
+            result.service_time.samples.push_back(service_time);
+        }
+        else
+        {
+            latency_moments.add(static_cast<double>(latency));
+            service_time_moments.add(static_cast<double>(service_time));
+        }
+    }
+
+    detail::update_statistics(result.latency, result.latency_histogram, &latency_moments);
+    detail::update_statistics(result.service_time, result.service_time_histogram, &service_time_moments);
+
+    const auto measured_time = std::chrono::duration<double>{std::max(last_done, end) - measure_start}.count();
+    result.achieved_rate = measured_time > 0 ? static_cast<double>(measured_operations) / measured_time : 0.0;
+
+    return result;
+}
+
+} // namespace jg
@@ -0,0 +1,1187 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <istream>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "jg_benchmark.h"
+#include "jg_benchmark_environment.h"
+#include "jg_string.h"
+
+/// @file Output of `benchmark_result` collections as a fixed-width table, JSON or CSV, reloading of JSON
+/// or CSV output as a baseline, and comparison of results against a baseline.
+
+namespace jg::detail {
+
+inline void write_json_string(std::ostream& stream, std::string_view string)
+{
+    stream << '"';
+
+    for (const char c : string)
+    {
+        switch (c)
+        {
+            case '"':  stream << "\\\""; break;
+            case '\\': stream << "\\\\"; break;
+            case '\n': stream << "\\n";  break;
+            case '\r': stream << "\\r";  break;
+            case '\t': stream << "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    stream << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xf] << "0123456789abcdef"[c & 0xf];
+                else
+                    stream << c;
+        }
+    }
+
+    stream << '"';
+}
+
+inline void write_csv_string(std::ostream& stream, std::string_view string)
+{
+    stream << '"';
+
+    for (const char c : string)
+        stream << (c == '"' ? "\"\"" : std::string_view{&c, 1});
+
+    stream << '"';
+}
+
+/// Minimal JSON document model, sufficient for reading back what `write_json()` writes. Numbers are
+/// kept as their text, so that 64-bit integers are read back without a round trip through `double`.
+struct json_value final
+{
+    enum class kind { null, boolean, number, string, array, object };
+
+    kind type{kind::null};
+    std::string text;               // boolean ("true"/"false"), number and string
+    std::vector<std::string> keys;  // object
+    std::vector<json_value> values; // object and array
+
+    const json_value* find(std::string_view key) const
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            if (keys[i] == key)
+                return &values[i];
+
+        return nullptr;
+    }
+};
+
+class json_reader final
+{
+public:
+    explicit json_reader(std::string_view json)
+        : m_json{json}
+    {}
+
+    std::optional<json_value> read()
+    {
+        auto value = read_value();
+
+        skip_space();
+
+        if (!value || m_pos != m_json.size())
+            return std::nullopt;
+
+        return value;
+    }
+
+private:
+    void skip_space()
+    {
+        while (m_pos < m_json.size() && std::isspace(static_cast<unsigned char>(m_json[m_pos])))
+            ++m_pos;
+    }
+
+    bool consume(char c)
+    {
+        skip_space();
+
+        if (m_pos < m_json.size() && m_json[m_pos] == c)
+            return ++m_pos, true;
+
+        return false;
+    }
+
+    bool consume(std::string_view word)
+    {
+        if (m_json.substr(m_pos, word.size()) != word)
+            return false;
+
+        m_pos += word.size();
+        return true;
+    }
+
+    // The four hex digits after "\\u".
+    std::optional<unsigned> read_code_unit()
+    {
+        unsigned code = 0;
+
+        for (size_t i = 0; i < 4; ++i, ++m_pos)
+        {
+            const char digit = m_pos < m_json.size() ? static_cast<char>(std::tolower(static_cast<unsigned char>(m_json[m_pos]))) : 'x';
+
+            if (!std::isxdigit(static_cast<unsigned char>(digit)))
+                return std::nullopt;
+
+            code = code * 16 + static_cast<unsigned>(std::isdigit(static_cast<unsigned char>(digit)) ? digit - '0' : digit - 'a' + 10);
+        }
+
+        return code;
+    }
+
+    static void append_utf8(std::string& string, unsigned code)
+    {
+        if (code < 0x80)
+            string += static_cast<char>(code);
+        else if (code < 0x800)
+        {
+            string += static_cast<char>(0xc0 | (code >> 6));
+            string += static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else if (code < 0x10000)
+        {
+            string += static_cast<char>(0xe0 | (code >> 12));
+            string += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            string += static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else
+        {
+            string += static_cast<char>(0xf0 | (code >> 18));
+            string += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            string += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            string += static_cast<char>(0x80 | (code & 0x3f));
+        }
+    }
+
+    std::optional<std::string> read_string()
+    {
+        if (!consume('"'))
+            return std::nullopt;
+
+        std::string string;
+
+        while (m_pos < m_json.size())
+        {
+            const char c = m_json[m_pos++];
+
+            if (c == '"')
+                return string;
+
+            if (c != '\\')
+            {
+                string += c;
+                continue;
+            }
+
+            if (m_pos == m_json.size())
+                return std::nullopt;
+
+            switch (const char escaped = m_json[m_pos++])
+            {
+                case 'n': string += '\n'; break;
+                case 'r': string += '\r'; break;
+                case 't': string += '\t'; break;
+                case 'b': string += '\b'; break;
+                case 'f': string += '\f'; break;
+                case 'u':
+                {
+                    // write_json() only escapes control characters and passes UTF-8 through, but other
+                    // writers may escape any code point, with those above 0xffff as surrogate pairs.
+                    auto code = read_code_unit();
+
+                    if (!code)
+                        return std::nullopt;
+
+                    if (*code >= 0xd800 && *code < 0xdc00 && m_json.compare(m_pos, 2, "\\u") == 0)
+                    {
+                        const size_t low_pos = m_pos;
+                        m_pos += 2;
+                        const auto low = read_code_unit();
+
+                        if (!low)
+                            return std::nullopt;
+
+                        if (*low >= 0xdc00 && *low < 0xe000)
+                            code = 0x10000 + ((*code - 0xd800) << 10) + (*low - 0xdc00);
+                        else
+                            m_pos = low_pos;
+                    }
+
+                    append_utf8(string, *code >= 0xd800 && *code < 0xe000 ? 0xfffd : *code);
+                    break;
+                }
+                default: string += escaped; break;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<json_value> read_value()
+    {
+        skip_space();
+
+        if (m_pos == m_json.size())
+            return std::nullopt;
+
+        json_value value;
+        const char c = m_json[m_pos];
+
+        if (c == '{')
+        {
+            value.type = json_value::kind::object;
+            ++m_pos;
+
+            if (consume('}'))
+                return value;
+
+            do
+            {
+                auto key = read_string();
+
+                if (!key || !consume(':'))
+                    return std::nullopt;
+
+                auto member = read_value();
+
+                if (!member)
+                    return std::nullopt;
+
+                value.keys.push_back(std::move(*key));
+                value.values.push_back(std::move(*member));
+            }
+            while (consume(','));
+
+            return consume('}') ? std::optional<json_value>{std::move(value)} : std::nullopt;
+        }
+
+        if (c == '[')
+        {
+            value.type = json_value::kind::array;
+            ++m_pos;
+
+            if (consume(']'))
+                return value;
+
+            do
+            {
+                auto item = read_value();
+
+                if (!item)
+                    return std::nullopt;
+
+                value.values.push_back(std::move(*item));
+            }
+            while (consume(','));
+
+            return consume(']') ? std::optional<json_value>{std::move(value)} : std::nullopt;
+        }
+
+        if (c == '"')
+        {
+            auto string = read_string();
+
+            if (!string)
+                return std::nullopt;
+
+            value.type = json_value::kind::string;
+            value.text = std::move(*string);
+            return value;
+        }
+
+        if (consume("true") || consume("false"))
+        {
+            value.type = json_value::kind::boolean;
+            value.text = c == 't' ? "true" : "false";
+            return value;
+        }
+
+        if (consume("null"))
+            return value;
+
+        const size_t first = m_pos;
+
+        while (m_pos < m_json.size() && std::string_view{"+-0123456789.eE"}.find(m_json[m_pos]) != std::string_view::npos)
+            ++m_pos;
+
+        if (first == m_pos)
+            return std::nullopt;
+
+        value.type = json_value::kind::number;
+        value.text = m_json.substr(first, m_pos - first);
+        return value;
+    }
+
+    std::string_view m_json;
+    size_t m_pos{};
+};
+
+/// Formats `value` with three significant digits and an SI prefix, like "1.23 G" for 1234567890.
+inline std::string si_string(double value)
+{
+    static constexpr const char* prefixes[] = {"", " k", " M", " G", " T", " P", " E"};
+
+    size_t prefix = 0;
+    for (; std::abs(value) >= 999.5 && prefix + 1 < std::size(prefixes); ++prefix)
+        value /= 1000;
+
+    std::ostringstream stream;
+    stream << std::setprecision(3) << value << prefixes[prefix];
+    return stream.str();
+}
+
+template <typename T>
+std::optional<T> number_from_text(std::string_view text)
+{
+    if constexpr (std::is_integral_v<T>)
+    {
+        if (auto value = jg::from_chars<T>(text))
+            return value;
+    }
+
+    // Integer fields written by other tools may have a fraction or an exponent.
+    const std::string string{text};
+    char* end{};
+    const double value = std::strtod(string.c_str(), &end);
+
+    if (string.empty() || end != string.c_str() + string.size())
+        return std::nullopt;
+
+    return static_cast<T>(value);
+}
+
+/// Splits one CSV line into fields. Fields may be quoted, with "" as an escaped quote.
+inline std::vector<std::string> csv_fields(std::string_view line)
+{
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+
+    for (size_t i = 0; i < line.size(); ++i)
+    {
+        const char c = line[i];
+
+        if (quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+            fields.back() += '"', ++i;
+        else if (c == '"')
+            quoted = !quoted;
+        else if (c == ',' && !quoted)
+            fields.emplace_back();
+        else if (c != '\r')
+            fields.back() += c;
+    }
+
+    return fields;
+}
+
+struct environment_field final
+{
+    std::string_view key;
+    std::string text;
+    bool quoted{}; // As a JSON string.
+};
+
+/// The fields of `environment` that have a value, as text.
+inline std::vector<environment_field> environment_fields(const benchmark_environment& environment)
+{
+    std::vector<environment_field> fields;
+
+    auto add = [&fields] (std::string_view key, std::string text, bool quoted) {
+        if (!text.empty())
+            fields.push_back({key, std::move(text), quoted});
+    };
+
+    auto optional_text = [] (const auto& value) {
+        std::ostringstream stream;
+        if (value)
+            stream << std::boolalpha << *value;
+        return stream.str();
+    };
+
+    add("cpu_model", environment.cpu_model, true);
+    add("cpu_count", std::to_string(environment.cpu_count), false);
+    add("last_level_cache_size", optional_text(environment.last_level_cache_size), false);
+    add("governor", environment.governor, true);
+    add("turbo", optional_text(environment.turbo), false);
+    add("load_average", optional_text(environment.load_average), false);
+    add("kernel", environment.kernel, true);
+    add("compiler", environment.compiler, true);
+    add("build_flags", environment.build_flags, true);
+    add("pinned_cpu", optional_text(environment.pinned_cpu), false);
+
+    return fields;
+}
+
+/// Sets the field `key` of `environment` from `text`, as written by `environment_fields()`. Unknown keys
+/// are ignored.
+inline void set_environment_field(benchmark_environment& environment, std::string_view key, const std::string& text)
+{
+    if (key == "cpu_model")                  environment.cpu_model             = text;
+    else if (key == "cpu_count")             environment.cpu_count             = jg::from_chars<size_t>(text).value_or(0);
+    else if (key == "last_level_cache_size") environment.last_level_cache_size = jg::from_chars<size_t>(text);
+    else if (key == "governor")              environment.governor              = text;
+    else if (key == "turbo")                 environment.turbo                 = text == "true";
+    else if (key == "load_average")          environment.load_average          = jg::from_chars<double>(text);
+    else if (key == "kernel")                environment.kernel                = text;
+    else if (key == "compiler")              environment.compiler              = text;
+    else if (key == "build_flags")           environment.build_flags           = text;
+    else if (key == "pinned_cpu")            environment.pinned_cpu            = jg::from_chars<size_t>(text);
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// Writes `results` as a fixed-width table, one row per result, followed by the samples.
+inline void write_table(std::ostream& stream, const std::vector<benchmark_result>& results)
+{
+    using namespace std::string_literals;
+
+    if (results.empty())
+        return;
+
+    const bool allocations = std::any_of(results.begin(), results.end(), [] (const auto& b) { return b.allocations.has_value(); });
+    const bool items = std::any_of(results.begin(), results.end(), [] (const auto& b) { return b.items_per_second.has_value(); });
+    const bool bytes = std::any_of(results.begin(), results.end(), [] (const auto& b) { return b.bytes_per_second.has_value(); });
+    const bool cycles = std::any_of(results.begin(), results.end(), [] (const auto& b) { return b.cycles.has_value(); });
+    const bool process = std::any_of(results.begin(), results.end(), [] (const auto& b) { return b.process.has_value(); });
+
+    std::vector<std::string> column_labels
+    {
+        "average (ns)"s,
+        "median (ns)"s,
+        "std (ns)"s,
+        "mad (ns)"s,
+        "p90 (ns)"s,
+        "p99 (ns)"s,
+        "p99.9 (ns)"s,
+        "max (ns)"s
+    };
+
+    if (allocations)
+        column_labels.insert(column_labels.end(), {"allocs"s, "alloc bytes"s, "peak bytes"s});
+
+    if (cycles)
+        column_labels.push_back("cycles"s);
+
+    if (items)
+        column_labels.push_back("items/s"s);
+
+    if (bytes)
+        column_labels.push_back("bytes/s"s);
+
+    if (process)
+        column_labels.insert(column_labels.end(), {"max RSS"s, "page faults"s});
+
+    column_labels.push_back("samples (ns)"s);
+
+    const size_t column1_width = std::max_element(
+        results.begin(),
+        results.end(),
+        [](const auto& b1, const auto& b2)
+        { return b1.description.length() < b2.description.length(); })->description.length() + 3;
+
+    const size_t columnN_width = std::max_element(
+        column_labels.begin(),
+        column_labels.end(),
+        [](const auto& l1, const auto& l2)
+        { return l1.length() < l2.length(); })->length() + 2;
+
+    stream << '\n';
+
+    auto width = column1_width + columnN_width;
+    for (auto& label : column_labels)
+    {
+        stream << std::setw(width) << label;
+        width = columnN_width;
+    }
+
+    stream << '\n';
+
+    const std::string header_(columnN_width - 2, '-');
+    width = column1_width + columnN_width;
+    for (size_t i = 0; i < column_labels.size(); ++i)
+    {
+        stream << std::setw(width) << header_;
+        width = columnN_width;
+    }
+
+    stream << '\n';
+
+    for (const auto& b : results)
+    {
+        stream << std::setw(column1_width) << std::left << b.description << std::right
+               << std::setw(columnN_width) << b.average
+               << std::setw(columnN_width) << b.median
+               << std::setw(columnN_width) << b.std_deviation
+               << std::setw(columnN_width) << b.median_abs_deviation
+               << std::setw(columnN_width) << b.p90
+               << std::setw(columnN_width) << b.p99
+               << std::setw(columnN_width) << b.p999
+               << std::setw(columnN_width) << b.max;
+
+        if (b.allocations)
+            stream << std::setw(columnN_width) << b.allocations->allocations
+                   << std::setw(columnN_width) << b.allocations->bytes
+                   << std::setw(columnN_width) << b.allocations->peak_live_bytes;
+        else if (allocations)
+            stream << std::setw(columnN_width) << '-'
+                   << std::setw(columnN_width) << '-'
+                   << std::setw(columnN_width) << '-';
+
+        if (b.cycles)
+            stream << std::setw(columnN_width) << b.cycles->median;
+        else if (cycles)
+            stream << std::setw(columnN_width) << '-';
+
+        if (items)
+            stream << std::setw(columnN_width) << (b.items_per_second ? detail::si_string(*b.items_per_second) : "-"s);
+
+        if (bytes)
+            stream << std::setw(columnN_width) << (b.bytes_per_second ? detail::si_string(*b.bytes_per_second) + 'B' : "-"s);
+
+        if (b.process)
+            stream << std::setw(columnN_width) << detail::si_string(static_cast<double>(b.process->max_rss_bytes)) + 'B'
+                   << std::setw(columnN_width) << b.process->minor_page_faults + b.process->major_page_faults;
+        else if (process)
+            stream << std::setw(columnN_width) << '-'
+                   << std::setw(columnN_width) << '-';
+
+        stream << "  [" << jg::ostream_join(b.samples.begin(), b.samples.end(), ", ") << "]\n";
+    }
+}
+
+/// Writes `environment` as "key: value" lines, for reading by humans.
+inline void write_environment(std::ostream& stream, const benchmark_environment& environment)
+{
+    for (const auto& field : detail::environment_fields(environment))
+        stream << field.key << ": " << field.text << '\n';
+}
+
+/// Writes `results` as a JSON document that `read_benchmark_results()` can read back, and
+/// `environment`, if any, that `read_benchmark_environment()` can read back.
+inline void write_json(std::ostream& stream, const std::vector<benchmark_result>& results,
+                       const std::optional<benchmark_environment>& environment = std::nullopt)
+{
+    const auto precision = stream.precision(10);
+
+    stream << '{';
+
+    if (environment)
+    {
+        const auto fields = detail::environment_fields(*environment);
+        stream << "\n  \"environment\": {";
+
+        for (size_t i = 0; i < fields.size(); ++i)
+        {
+            stream << (i > 0 ? ",\n" : "\n") << "    ";
+            detail::write_json_string(stream, fields[i].key);
+            stream << ": ";
+
+            if (fields[i].quoted)
+                detail::write_json_string(stream, fields[i].text);
+            else
+                stream << fields[i].text;
+        }
+
+        stream << (fields.empty() ? "}," : "\n  },");
+    }
+
+    stream << "\n  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& b = results[i];
+
+        stream << (i > 0 ? ",\n" : "\n") << "    {\n      \"description\": ";
+        detail::write_json_string(stream, b.description);
+        stream << ",\n      \"average\": "              << b.average
+               << ",\n      \"median\": "               << b.median
+               << ",\n      \"std_deviation\": "        << b.std_deviation
+               << ",\n      \"median_abs_deviation\": " << b.median_abs_deviation
+               << ",\n      \"p90\": "                  << b.p90
+               << ",\n      \"p99\": "                  << b.p99
+               << ",\n      \"p999\": "                 << b.p999
+               << ",\n      \"max\": "                  << b.max;
+
+        if (b.perf_counters)
+        {
+            const auto& p = *b.perf_counters;
+            stream << ",\n      \"perf_counters\": {"
+                   << "\"cycles\": "                   << p.cycles
+                   << ", \"instructions\": "           << p.instructions
+                   << ", \"cache_misses\": "           << p.cache_misses
+                   << ", \"branch_misses\": "          << p.branch_misses
+                   << ", \"page_faults\": "            << p.page_faults
+                   << ", \"instructions_per_cycle\": " << p.instructions_per_cycle
+                   << ", \"cache_miss_rate\": "        << p.cache_miss_rate
+                   << ", \"branch_miss_rate\": "       << p.branch_miss_rate
+                   << ", \"multiplexed\": "            << (p.multiplexed ? "true" : "false") << '}';
+        }
+
+        if (b.allocations)
+        {
+            stream << ",\n      \"allocations\": {"
+                   << "\"allocations\": "       << b.allocations->allocations
+                   << ", \"bytes\": "           << b.allocations->bytes
+                   << ", \"peak_live_bytes\": " << b.allocations->peak_live_bytes << '}';
+        }
+
+        if (b.cycles)
+        {
+            stream << ",\n      \"cycles\": {"
+                   << "\"median\": "           << b.cycles->median
+                   << ", \"average\": "        << b.cycles->average
+                   << ", \"ns_per_cycle\": "   << b.cycles->ns_per_cycle
+                   << ", \"timer_overhead\": " << b.cycles->timer_overhead << '}';
+        }
+
+        if (b.items_per_second)
+            stream << ",\n      \"items_per_second\": " << *b.items_per_second;
+
+        if (b.bytes_per_second)
+            stream << ",\n      \"bytes_per_second\": " << *b.bytes_per_second;
+
+        if (b.process)
+        {
+            stream << ",\n      \"process\": {"
+                   << "\"max_rss_bytes\": "       << b.process->max_rss_bytes
+                   << ", \"minor_page_faults\": " << b.process->minor_page_faults
+                   << ", \"major_page_faults\": " << b.process->major_page_faults << '}';
+        }
+
+        stream << ",\n      \"samples\": [" << jg::ostream_join(b.samples.begin(), b.samples.end(), ", ") << "]\n    }";
+    }
+
+    stream << (results.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    stream.precision(precision);
+}
+
+/// Writes `results` as CSV with a header row that `read_benchmark_results()` can read back. The samples
+/// are written space separated in the last column. Perf counter, allocation, throughput, cycle and
+/// process columns are empty when not measured. `environment`, if any, is written before the header
+/// as "# key: value" lines, that `read_benchmark_environment()` can read back.
+inline void write_csv(std::ostream& stream, const std::vector<benchmark_result>& results,
+                      const std::optional<benchmark_environment>& environment = std::nullopt)
+{
+    const auto precision = stream.precision(10);
+
+    if (environment)
+        for (const auto& field : detail::environment_fields(*environment))
+            stream << "# " << field.key << ": " << field.text << '\n';
+
+    stream << "description,average,median,std_deviation,median_abs_deviation,p90,p99,p999,max,"
+              "cycles,instructions,cache_misses,branch_misses,page_faults,"
+              "instructions_per_cycle,cache_miss_rate,branch_miss_rate,perf_multiplexed,"
+              "allocations,allocated_bytes,peak_live_bytes,items_per_second,bytes_per_second,"
+              "median_cycles,average_cycles,ns_per_cycle,timer_overhead_cycles,"
+              "max_rss_bytes,minor_page_faults,major_page_faults,samples\n";
+
+    for (const auto& b : results)
+    {
+        detail::write_csv_string(stream, b.description);
+        stream << ',' << b.average
+               << ',' << b.median
+               << ',' << b.std_deviation
+               << ',' << b.median_abs_deviation
+               << ',' << b.p90
+               << ',' << b.p99
+               << ',' << b.p999
+               << ',' << b.max << ',';
+
+        if (b.perf_counters)
+        {
+            const auto& p = *b.perf_counters;
+            stream << p.cycles << ',' << p.instructions << ',' << p.cache_misses << ',' << p.branch_misses << ','
+                   << p.page_faults << ',' << p.instructions_per_cycle << ',' << p.cache_miss_rate << ','
+                   << p.branch_miss_rate << ',' << (p.multiplexed ? "true" : "false") << ',';
+        }
+        else
+            stream << ",,,,,,,,,";
+
+        if (b.allocations)
+            stream << b.allocations->allocations << ',' << b.allocations->bytes << ',' << b.allocations->peak_live_bytes << ',';
+        else
+            stream << ",,,";
+
+        if (b.items_per_second)
+            stream << *b.items_per_second;
+
+        stream << ',';
+
+        if (b.bytes_per_second)
+            stream << *b.bytes_per_second;
+
+        stream << ',';
+
+        if (b.cycles)
+            stream << b.cycles->median << ',' << b.cycles->average << ',' << b.cycles->ns_per_cycle << ',' << b.cycles->timer_overhead << ',';
+        else
+            stream << ",,,,";
+
+        if (b.process)
+            stream << b.process->max_rss_bytes << ',' << b.process->minor_page_faults << ',' << b.process->major_page_faults << ',';
+        else
+            stream << ",,,";
+
+        stream << jg::ostream_join(b.samples.begin(), b.samples.end(), " ") << '\n';
+    }
+
+    stream.precision(precision);
+}
+
+/// Reads results written by `write_json()` or `write_csv()`, for instance to use as a baseline in
+/// `compare()`. The format is detected from the first character. Unknown fields and columns are ignored.
+/// @returns The results, or `std::nullopt` if `stream` doesn't hold a valid document.
+inline std::optional<std::vector<benchmark_result>> read_benchmark_results(std::istream& stream)
+{
+    using sample_type = benchmark_result::sample_type;
+
+    const std::string document{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+    const auto first = document.find_first_not_of(" \t\r\n");
+
+    if (first == std::string::npos)
+        return std::nullopt;
+
+    std::vector<benchmark_result> results;
+
+    if (document[first] == '{')
+    {
+        const auto json = detail::json_reader{document}.read();
+        const auto* benchmarks = json ? json->find("benchmarks") : nullptr;
+
+        if (!benchmarks || benchmarks->type != detail::json_value::kind::array)
+            return std::nullopt;
+
+        for (const auto& item : benchmarks->values)
+        {
+            benchmark_result result;
+
+            auto read_number = [&item] (std::string_view key, auto& field) {
+                if (const auto* value = item.find(key); value && value->type == detail::json_value::kind::number)
+                    if (auto number = detail::number_from_text<std::decay_t<decltype(field)>>(value->text))
+                        field = *number;
+            };
+
+            if (const auto* description = item.find("description"))
+                result.description = description->text;
+
+            read_number("average", result.average);
+            read_number("median", result.median);
+            read_number("std_deviation", result.std_deviation);
+            read_number("median_abs_deviation", result.median_abs_deviation);
+            read_number("p90", result.p90);
+            read_number("p99", result.p99);
+            read_number("p999", result.p999);
+            read_number("max", result.max);
+
+            if (const auto* perf = item.find("perf_counters"); perf && perf->type == detail::json_value::kind::object)
+            {
+                auto& p = result.perf_counters.emplace();
+                const detail::json_value& counters = *perf;
+
+                auto read_counter = [&counters] (std::string_view key, double& field) {
+                    if (const auto* value = counters.find(key))
+                        field = detail::number_from_text<double>(value->text).value_or(0.0);
+                };
+
+                read_counter("cycles", p.cycles);
+                read_counter("instructions", p.instructions);
+                read_counter("cache_misses", p.cache_misses);
+                read_counter("branch_misses", p.branch_misses);
+                read_counter("page_faults", p.page_faults);
+                read_counter("instructions_per_cycle", p.instructions_per_cycle);
+                read_counter("cache_miss_rate", p.cache_miss_rate);
+                read_counter("branch_miss_rate", p.branch_miss_rate);
+
+                if (const auto* value = counters.find("multiplexed"))
+                    p.multiplexed = value->text == "true";
+            }
+
+            if (const auto* allocations = item.find("allocations"); allocations && allocations->type == detail::json_value::kind::object)
+            {
+                auto& a = result.allocations.emplace();
+
+                if (const auto* value = allocations->find("allocations"))
+                    a.allocations = detail::number_from_text<double>(value->text).value_or(0.0);
+
+                if (const auto* value = allocations->find("bytes"))
+                    a.bytes = detail::number_from_text<double>(value->text).value_or(0.0);
+
+                if (const auto* value = allocations->find("peak_live_bytes"))
+                    a.peak_live_bytes = detail::number_from_text<int64_t>(value->text).value_or(0);
+            }
+
+            if (const auto* cycles = item.find("cycles"); cycles && cycles->type == detail::json_value::kind::object)
+            {
+                auto& c = result.cycles.emplace();
+
+                auto read_cycles = [cycles] (std::string_view key, double& field) {
+                    if (const auto* value = cycles->find(key))
+                        field = detail::number_from_text<double>(value->text).value_or(0.0);
+                };
+
+                read_cycles("median", c.median);
+                read_cycles("average", c.average);
+                read_cycles("ns_per_cycle", c.ns_per_cycle);
+                read_cycles("timer_overhead", c.timer_overhead);
+            }
+
+            if (const auto* value = item.find("items_per_second"))
+                result.items_per_second = detail::number_from_text<double>(value->text);
+
+            if (const auto* value = item.find("bytes_per_second"))
+                result.bytes_per_second = detail::number_from_text<double>(value->text);
+
+            if (const auto* process = item.find("process"); process && process->type == detail::json_value::kind::object)
+            {
+                auto& p = result.process.emplace();
+
+                auto read_usage = [process] (std::string_view key, int64_t& field) {
+                    if (const auto* value = process->find(key))
+                        field = detail::number_from_text<int64_t>(value->text).value_or(0);
+                };
+
+                read_usage("max_rss_bytes", p.max_rss_bytes);
+                read_usage("minor_page_faults", p.minor_page_faults);
+                read_usage("major_page_faults", p.major_page_faults);
+            }
+
+            if (const auto* samples = item.find("samples"))
+                for (const auto& sample : samples->values)
+                    if (auto value = detail::number_from_text<sample_type>(sample.text))
+                        result.samples.push_back(*value);
+
+            results.push_back(std::move(result));
+        }
+
+        return results;
+    }
+
+    std::istringstream lines{document};
+    std::string line;
+
+    do
+    {
+        if (!std::getline(lines, line))
+            return std::nullopt;
+    }
+    while (!line.empty() && line[0] == '#'); // Environment lines, before the header.
+
+    const auto header = detail::csv_fields(line);
+
+    auto column = [&header] (std::string_view name) {
+        return static_cast<size_t>(std::find(header.begin(), header.end(), name) - header.begin());
+    };
+
+    if (column("description") == header.size())
+        return std::nullopt;
+
+    while (std::getline(lines, line))
+    {
+        if (line.empty() || line == "\r")
+            continue;
+
+        const auto fields = detail::csv_fields(line);
+        benchmark_result result;
+
+        auto field = [&] (std::string_view name) -> std::string_view {
+            const size_t index = column(name);
+            return index < fields.size() ? std::string_view{fields[index]} : std::string_view{};
+        };
+
+        auto read_number = [&] (std::string_view name, sample_type& value) {
+            value = detail::number_from_text<sample_type>(field(name)).value_or(0);
+        };
+
+        result.description = field("description");
+        read_number("average", result.average);
+        read_number("median", result.median);
+        read_number("std_deviation", result.std_deviation);
+        read_number("median_abs_deviation", result.median_abs_deviation);
+        read_number("p90", result.p90);
+        read_number("p99", result.p99);
+        read_number("p999", result.p999);
+        read_number("max", result.max);
+
+        if (!field("instructions_per_cycle").empty())
+        {
+            auto& p = result.perf_counters.emplace();
+
+            auto read_counter = [&] (std::string_view name, double& value) {
+                value = detail::number_from_text<double>(field(name)).value_or(0.0);
+            };
+
+            read_counter("cycles", p.cycles);
+            read_counter("instructions", p.instructions);
+            read_counter("cache_misses", p.cache_misses);
+            read_counter("branch_misses", p.branch_misses);
+            read_counter("page_faults", p.page_faults);
+            read_counter("instructions_per_cycle", p.instructions_per_cycle);
+            read_counter("cache_miss_rate", p.cache_miss_rate);
+            read_counter("branch_miss_rate", p.branch_miss_rate);
+            p.multiplexed = field("perf_multiplexed") == "true";
+        }
+
+        if (!field("allocations").empty())
+        {
+            auto& a = result.allocations.emplace();
+            a.allocations     = detail::number_from_text<double>(field("allocations")).value_or(0.0);
+            a.bytes           = detail::number_from_text<double>(field("allocated_bytes")).value_or(0.0);
+            a.peak_live_bytes = detail::number_from_text<int64_t>(field("peak_live_bytes")).value_or(0);
+        }
+
+        if (!field("median_cycles").empty())
+        {
+            auto& c = result.cycles.emplace();
+            c.median         = detail::number_from_text<double>(field("median_cycles")).value_or(0.0);
+            c.average        = detail::number_from_text<double>(field("average_cycles")).value_or(0.0);
+            c.ns_per_cycle   = detail::number_from_text<double>(field("ns_per_cycle")).value_or(0.0);
+            c.timer_overhead = detail::number_from_text<double>(field("timer_overhead_cycles")).value_or(0.0);
+        }
+
+        if (!field("items_per_second").empty())
+            result.items_per_second = detail::number_from_text<double>(field("items_per_second"));
+
+        if (!field("bytes_per_second").empty())
+            result.bytes_per_second = detail::number_from_text<double>(field("bytes_per_second"));
+
+        if (!field("max_rss_bytes").empty())
+        {
+            auto& p = result.process.emplace();
+            p.max_rss_bytes     = detail::number_from_text<int64_t>(field("max_rss_bytes")).value_or(0);
+            p.minor_page_faults = detail::number_from_text<int64_t>(field("minor_page_faults")).value_or(0);
+            p.major_page_faults = detail::number_from_text<int64_t>(field("major_page_faults")).value_or(0);
+        }
+
+        std::istringstream samples{std::string{field("samples")}};
+        for (sample_type sample{}; samples >> sample;)
+            result.samples.push_back(sample);
+
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+/// Reads the environment written by `write_json()` or `write_csv()`.
+/// @returns The environment, or `std::nullopt` if `stream` doesn't hold one.
+inline std::optional<benchmark_environment> read_benchmark_environment(std::istream& stream)
+{
+    const std::string document{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+    const auto first = document.find_first_not_of(" \t\r\n");
+
+    if (first == std::string::npos)
+        return std::nullopt;
+
+    benchmark_environment environment;
+
+    if (document[first] == '{')
+    {
+        const auto json = detail::json_reader{document}.read();
+        const auto* fields = json ? json->find("environment") : nullptr;
+
+        if (!fields || fields->type != detail::json_value::kind::object)
+            return std::nullopt;
+
+        for (size_t i = 0; i < fields->keys.size(); ++i)
+            detail::set_environment_field(environment, fields->keys[i], fields->values[i].text);
+
+        return environment;
+    }
+
+    std::istringstream lines{document};
+    bool found = false;
+
+    for (std::string line; std::getline(lines, line) && !line.empty() && line[0] == '#';)
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        const auto colon = line.find(": ");
+
+        if (colon == std::string::npos || colon < 2)
+            continue;
+
+        detail::set_environment_field(environment, std::string_view{line}.substr(2, colon - 2), line.substr(colon + 2));
+        found = true;
+    }
+
+    return found ? std::optional<benchmark_environment>{std::move(environment)} : std::nullopt;
+}
+
+enum class benchmark_change
+{
+    unchanged,
+    improved,
+    regressed
+};
+
+constexpr std::string_view to_string(benchmark_change change) noexcept
+{
+    switch (change)
+    {
+        case benchmark_change::unchanged: return "unchanged";
+        case benchmark_change::improved:  return "improved";
+        case benchmark_change::regressed: return "regressed";
+        default:                          return "<unknown>";
+    }
+}
+
+struct benchmark_comparison_options final
+{
+    double alpha{0.05};     // Significance level of the Mann-Whitney U test.
+    double threshold{0.05}; // Minimum relative change of the median that counts as a change.
+};
+
+struct benchmark_comparison final
+{
+    std::string description;
+    benchmark_result::sample_type baseline_median{};
+    benchmark_result::sample_type median{};
+    double ratio{1};   // median / baseline_median
+    double p_value{1}; // Mann-Whitney U over the samples. 1 if either result has no samples.
+    bool tested{};     // If both results have samples, so that a change can be detected. Never changed if not.
+    benchmark_change change{};
+};
+
+/// Compares each result in `current` with the result with the same description in `baseline`. A result
+/// has changed if the difference between the samples is statistically significant at `options.alpha` and
+/// the median has changed by more than `options.threshold`. Results without a baseline are left out.
+inline std::vector<benchmark_comparison> compare(const std::vector<benchmark_result>& baseline,
+                                                 const std::vector<benchmark_result>& current,
+                                                 const benchmark_comparison_options& options = {})
+{
+    std::vector<benchmark_comparison> comparisons;
+
+    for (const auto& result : current)
+    {
+        const auto base = std::find_if(baseline.begin(), baseline.end(),
+                                       [&result] (const auto& b) { return b.description == result.description; });
+
+        if (base == baseline.end())
+            continue;
+
+        benchmark_comparison comparison;
+        comparison.description     = result.description;
+        comparison.baseline_median = base->median;
+        comparison.median          = result.median;
+        comparison.ratio           = base->median > 0 ? static_cast<double>(result.median) / static_cast<double>(base->median) : 1.0;
+        comparison.tested          = !result.samples.empty() && !base->samples.empty();
+
+        if (comparison.tested)
+            comparison.p_value = jg::mann_whitney_u(result.samples.begin(), result.samples.end(),
+                                                    base->samples.begin(), base->samples.end()).p_value;
+
+        if (comparison.p_value < options.alpha)
+        {
+            if (comparison.ratio > 1 + options.threshold)
+                comparison.change = benchmark_change::regressed;
+            else if (comparison.ratio < 1 - options.threshold)
+                comparison.change = benchmark_change::improved;
+        }
+
+        comparisons.push_back(std::move(comparison));
+    }
+
+    return comparisons;
+}
+
+/// Writes one line per comparison, with the relative change of the median and the p-value.
+inline void write_comparison(std::ostream& stream, const std::vector<benchmark_comparison>& comparisons)
+{
+    if (comparisons.empty())
+        return;
+
+    const size_t column1_width = std::max_element(
+        comparisons.begin(),
+        comparisons.end(),
+        [](const auto& c1, const auto& c2)
+        { return c1.description.length() < c2.description.length(); })->description.length() + 3;
+
+    const auto flags = stream.flags();
+    const auto precision = stream.precision(3);
+
+    stream << '\n';
+
+    for (const auto& c : comparisons)
+    {
+        stream << std::setw(column1_width) << std::left << c.description << std::right
+               << std::setw(14) << c.baseline_median << " ns ->"
+               << std::setw(14) << c.median << " ns"
+               << std::setw(10) << std::showpos << std::fixed << std::setprecision(1) << (c.ratio - 1) * 100 << '%'
+               << std::noshowpos << std::setprecision(3) << "  p=" << std::setw(5) << c.p_value
+               << "  " << (c.tested ? to_string(c.change) : "untested, no samples") << '\n';
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+/// Writes `ab` as the medians of A and B, the distribution of the per-pair speedup ratios, and the median
+/// speedup of B over A with its confidence interval.
+inline void write_ab_comparison(std::ostream& stream, const benchmark_ab_result& ab)
+{
+    const auto flags = stream.flags();
+    const auto precision = stream.precision();
+
+    const auto width = static_cast<int>(std::max(ab.a.description.length(), ab.b.description.length()));
+
+    stream << '\n' << "A: " << std::setw(width) << std::left << ab.a.description << std::right << std::setw(14) << ab.a.median << " ns median\n"
+                  << "B: " << std::setw(width) << std::left << ab.b.description << std::right << std::setw(14) << ab.b.median << " ns median\n";
+
+    if (ab.ratios.empty())
+    {
+        stream << "No pairs with non-zero samples.\n";
+        return;
+    }
+
+    std::vector<double> ratios = ab.ratios;
+    std::sort(ratios.begin(), ratios.end());
+
+    auto quantile = [&ratios] (double q) {
+        return ratios[std::min(ratios.size() - 1, static_cast<size_t>(q * static_cast<double>(ratios.size())))];
+    };
+
+    stream << std::fixed << std::setprecision(3)
+           << "A/B ratios of " << ratios.size() << " pairs:"
+           << "  min " << ratios.front()
+           << "  p5 " << quantile(0.05)
+           << "  p25 " << quantile(0.25)
+           << "  p50 " << quantile(0.5)
+           << "  p75 " << quantile(0.75)
+           << "  p95 " << quantile(0.95)
+           << "  max " << ratios.back() << '\n'
+           << "Speedup of B: " << ab.median_ratio << "x, "
+           << std::setprecision(0) << ab.confidence * 100 << "% CI [" << std::setprecision(3) << ab.speedup.low << "x, " << ab.speedup.high << "x]"
+           << (ab.speedup.low > 1 ? ", B is faster\n" : ab.speedup.high < 1 ? ", B is slower\n" : ", no significant difference\n");
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+/// Counts the comparisons that regressed, typically to make the process exit code fail a run.
+inline size_t regression_count(const std::vector<benchmark_comparison>& comparisons)
+{
+    return static_cast<size_t>(std::count_if(comparisons.begin(), comparisons.end(),
+                                             [] (const auto& c) { return c.change == benchmark_change::regressed; }));
+}
+
+/// Counts the comparisons that couldn't be tested for a change, because either result has no samples,
+/// like when written with `retain_samples` off. A run that should catch regressions fails on these too.
+inline size_t untested_count(const std::vector<benchmark_comparison>& comparisons)
+{
+    return static_cast<size_t>(std::count_if(comparisons.begin(), comparisons.end(),
+                                             [] (const auto& c) { return !c.tested; }));
+}
+
+} // namespace jg
@@ -0,0 +1,483 @@
+#ifdef JG_BENCHMARK_IMPL
+#undef JG_BENCHMARK_INCLUDED
+#endif
+
+#ifndef JG_BENCHMARK_INCLUDED
+#define JG_BENCHMARK_INCLUDED
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "jg_args.h"
+#include "jg_benchmark.h"
+
+/// @file Registration of benchmarks spread over cpp files, and a runner that executes all of them, or a
+/// subset chosen on the command line.
+/// @note One translation unit *must* define JG_BENCHMARK_IMPL before including this header. This is
+/// typically done by the main cpp file. If no translation unit defines JG_BENCHMARK_IMPL, then there will
+/// be undefined symbol linker errors.
+/// @note By defining JG_BENCHMARK_MAIN before including this header, a `main()` that calls
+/// `jg::benchmark_run()` with the command line arguments is generated.
+
+namespace jg {
+
+struct benchmark_case final
+{
+    std::string description;
+    benchmark_options options;
+    std::function<void()> func;
+    std::function<void(benchmark_state&)> state_func; // Used instead of `func` if set.
+
+    benchmark_case(std::string description, std::function<void()> func)
+        : description{std::move(description)}
+        , func{std::move(func)}
+    {}
+
+    benchmark_case(std::string description, benchmark_options options, std::function<void()> func)
+        : description{std::move(description)}
+        , options{std::move(options)}
+        , func{std::move(func)}
+    {}
+
+    benchmark_case(std::string description, std::function<void(benchmark_state&)> state_func)
+        : description{std::move(description)}
+        , state_func{std::move(state_func)}
+    {}
+
+    benchmark_case(std::string description, benchmark_options options, std::function<void(benchmark_state&)> state_func)
+        : description{std::move(description)}
+        , options{std::move(options)}
+        , state_func{std::move(state_func)}
+    {}
+};
+
+struct benchmark_set final
+{
+    std::string description;
+    std::vector<benchmark_case> cases;
+};
+
+void benchmark_add(jg::benchmark_set&& set);
+
+/// Runs the added benchmarks, and returns the process exit code. The results are described as "set/case",
+/// also in baselines and histories. Unknown options, and values that don't parse, are errors with exit
+/// code 1. The command line options are:
+///
+///     --list                  Lists the benchmarks as "set/case" instead of running them.
+///     --filter=<text>         Only runs the benchmarks with "set/case" containing <text>.
+///     --repetitions=<count>   Overrides the sample count of all benchmarks.
+///     --min-time=<ms>         Keeps sampling each benchmark until at least <ms> milliseconds are measured.
+///     --perf-counters         Counts hardware events, when permitted.
+///     --allocations           Counts heap allocations, if JG_ALLOCATION_COUNTER_IMPL is defined by the program.
+///     --cycles                Times with jg::cycle_clock, minus its overhead, and reports cycles too.
+///     --cache=<mode>          One of warm (default), cold or both. Cold evicts the CPU caches before each
+///                             sample. Both runs each benchmark warm, and then cold described as "set/case/cold".
+///     --pin-cpu[=<cpu>]       Pins the benchmarks to <cpu>, or to the first CPU isolated with isolcpus.
+///     --rate=<per second>     Calls each benchmark open loop at <per second> for --min-time (default 1000 ms),
+///                             and reports the latency from the scheduled start and the service time.
+///     --isolate               Runs each benchmark in a forked child process, so that it doesn't inherit
+///                             heap, cache or lazy initialization state from the benchmarks before it, and
+///                             reports the child's peak RSS and page faults. The exit code is 1 if a child fails.
+///     --a=<set/case>          With --b, runs the two benchmarks interleaved, sample by sample, instead of
+///     --b=<set/case>          all benchmarks, and reports the speedup of B over A with a 95% confidence
+///                             interval. The speedup goes to stderr if the format isn't table.
+///     --no-samples            Doesn't retain the samples. Saves memory in long runs, but --baseline needs samples.
+///     --format=<format>       One of table (default), json or csv.
+///     --output=<file>         Writes the results to <file> instead of stdout.
+///     --baseline=<file>       Compares with results previously written as json or csv. The exit code is 1
+///                             if any benchmark has regressed, or has no samples to compare on either side.
+///                             Warns if the baseline was written in another environment.
+///     --threshold=<percent>   Median change that counts as a regression or improvement. Default is 5.
+///     --history=<file>        Appends the medians to <file>, keyed by the git commit and a hash of the environment.
+///     --commit=<id>           The commit to key the history by, instead of the checked out git commit.
+///     --trend                 Reports the trends and step changes of the medians in --history instead of
+///                             running the benchmarks. Steps smaller than --threshold aren't reported.
+int benchmark_run(jg::args args);
+
+/// A `benchmark_adder` instance can be used for "auto discovery" of benchmarks spread over cpp files, in
+/// the same way as `jg::test_adder`. Instantiate the `benchmark_adder` at global scope and it will add the
+/// benchmarks in its constructor, before `main()` is called.
+/// @example
+///     // flubber_benchmarks.cpp
+///     #include <jg_benchmark_runner.h>
+///     #include "flubber.h"
+///
+///     jg::benchmark_adder flubber_benchmarks { "flubber", {
+///         jg::benchmark_case { "flubber me this", [] {
+///             flubber();
+///         }},
+///         jg::benchmark_case { "flubber me that, 100 times", {10, 100}, [] {
+///             for (size_t i = 0; i < 100; ++i)
+///                 flubber();
+///         }},
+///         ...
+///     }};
+///
+///     // main.cpp
+///     #define JG_BENCHMARK_MAIN
+///     #define JG_BENCHMARK_IMPL
+///     #include <jg_benchmark_runner.h>
+struct benchmark_adder final
+{
+    benchmark_adder(std::string description, std::vector<benchmark_case>&& cases)
+    {
+        benchmark_add({std::move(description), std::move(cases)});
+    }
+};
+
+} // namespace jg
+
+#ifdef JG_BENCHMARK_IMPL
+#undef JG_BENCHMARK_IMPL
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string_view>
+#include <utility>
+#include "jg_benchmark_environment.h"
+#include "jg_benchmark_history.h"
+#include "jg_benchmark_isolation.h"
+#include "jg_benchmark_load.h"
+#include "jg_benchmark_report.h"
+
+static std::vector<jg::benchmark_set>& benchmark_sets()
+{
+    // To be able to use global benchmark_adder instances for easier benchmark registration,
+    // and avoid static init fiasco, this is created on first use.
+    static std::vector<jg::benchmark_set> instance;
+    return instance;
+}
+
+namespace jg {
+
+void benchmark_add(jg::benchmark_set&& set)
+{
+    benchmark_sets().push_back(std::move(set));
+}
+
+int benchmark_run(jg::args args)
+{
+    constexpr std::string_view value_options[] = {"--filter=", "--repetitions=", "--min-time=", "--format=", "--output=", "--baseline=",
+                                                  "--threshold=", "--cache=", "--pin-cpu=", "--rate=", "--history=", "--commit=", "--a=", "--b="};
+    constexpr std::string_view flag_options[] = {"--list", "--perf-counters", "--allocations", "--cycles", "--pin-cpu", "--isolate",
+                                                 "--no-samples", "--trend"};
+
+    // The first argument is the program.
+    for (auto arg = args.begin() == args.end() ? args.end() : args.begin() + 1; arg != args.end(); ++arg)
+    {
+        const std::string_view option{*arg};
+
+        if (std::find(std::begin(flag_options), std::end(flag_options), option) == std::end(flag_options) &&
+            std::none_of(std::begin(value_options), std::end(value_options), [option] (auto key) { return jg::starts_with(option, key); }))
+        {
+            std::cerr << "Unknown option '" << option << "'\n";
+            return 1;
+        }
+    }
+
+    const auto filter        = jg::args_key_value(args, "--filter=").value_or("");
+    const auto repetitions   = jg::from_chars<size_t>(jg::args_key_value(args, "--repetitions=").value_or(""));
+    const auto min_time_ms   = jg::from_chars<size_t>(jg::args_key_value(args, "--min-time=").value_or(""));
+    const auto format        = jg::args_key_value(args, "--format=").value_or("table");
+    const auto output_path   = jg::args_key_value(args, "--output=");
+    const auto baseline_path = jg::args_key_value(args, "--baseline=");
+    const auto threshold     = jg::from_chars<double>(jg::args_key_value(args, "--threshold=").value_or("5"));
+    const auto cache         = jg::args_key_value(args, "--cache=").value_or("warm");
+    const auto pin_cpu       = jg::args_key_value(args, "--pin-cpu=");
+    const auto rate          = jg::from_chars<double>(jg::args_key_value(args, "--rate=").value_or(""));
+    const auto history_path  = jg::args_key_value(args, "--history=");
+    const auto commit        = jg::args_key_value(args, "--commit=");
+    const auto ab_name_a     = jg::args_key_value(args, "--a=");
+    const auto ab_name_b     = jg::args_key_value(args, "--b=");
+    const bool list          = jg::args_has_key(args, "--list");
+    const bool isolate       = jg::args_has_key(args, "--isolate");
+
+    // Options that are given but don't parse would otherwise silently fall back to their defaults.
+    for (const auto& [key, parsed] : {std::pair{"--repetitions=", repetitions.has_value()},
+                                      std::pair{"--min-time=", min_time_ms.has_value()},
+                                      std::pair{"--threshold=", threshold.has_value()},
+                                      std::pair{"--rate=", rate.has_value()},
+                                      std::pair{"--pin-cpu=", !pin_cpu || jg::from_chars<size_t>(*pin_cpu).has_value()}})
+    {
+        if (!parsed && jg::args_key_value(args, key))
+        {
+            std::cerr << "Invalid value '" << *jg::args_key_value(args, key) << "' for " << std::string_view{key}.substr(0, std::string_view{key}.size() - 1) << '\n';
+            return 1;
+        }
+    }
+
+    if (format != "table" && format != "json" && format != "csv")
+    {
+        std::cerr << "Unknown format '" << format << "'\n";
+        return 1;
+    }
+
+    if (cache != "warm" && cache != "cold" && cache != "both")
+    {
+        std::cerr << "Unknown cache mode '" << cache << "'\n";
+        return 1;
+    }
+
+    if (jg::args_has_key(args, "--trend"))
+    {
+        std::ifstream history_file{std::string{history_path.value_or("")}};
+        const auto history = history_file ? jg::read_benchmark_history(history_file) : std::nullopt;
+
+        if (!history)
+        {
+            std::cerr << "Can't read history '" << history_path.value_or("") << "'\n";
+            return 1;
+        }
+
+        jg::write_trends(std::cout, jg::benchmark_trends(*history, threshold.value_or(5) / 100));
+        return 0;
+    }
+
+    auto environment = jg::capture_benchmark_environment();
+
+    if (!list && (pin_cpu || jg::args_has_key(args, "--pin-cpu")))
+    {
+        const auto cpu = pin_cpu ? jg::from_chars<size_t>(*pin_cpu) : jg::isolated_cpu();
+
+        if (!cpu)
+            std::cerr << "Warning: No isolated CPU, not pinning.\n";
+        else if (!jg::pin_to_cpu(*cpu))
+            std::cerr << "Warning: Can't pin to CPU " << *cpu << ".\n";
+        else
+            environment.pinned_cpu = cpu;
+    }
+
+    if (!list)
+        for (const auto& warning : jg::benchmark_environment_warnings(environment))
+            std::cerr << "Warning: " << warning << '\n';
+
+    auto with_args = [&] (benchmark_options options)
+    {
+        if (repetitions && *repetitions > 0)
+            options.sample_count = *repetitions;
+
+        if (min_time_ms)
+            options.min_time = std::chrono::milliseconds{*min_time_ms};
+
+        if (jg::args_has_key(args, "--perf-counters"))
+            options.perf_counters = true;
+
+        if (jg::args_has_key(args, "--allocations"))
+            options.count_allocations = true;
+
+        if (jg::args_has_key(args, "--cycles"))
+            options.cycle_timing = true;
+
+        if (jg::args_has_key(args, "--no-samples"))
+            options.retain_samples = false;
+
+        return options;
+    };
+
+    std::vector<benchmark_result> results;
+    size_t failed_count = 0;
+    std::optional<benchmark_ab_result> ab;
+
+    if (!list && ab_name_a.has_value() != ab_name_b.has_value())
+    {
+        std::cerr << "--a and --b must both be given\n";
+        return 1;
+    }
+
+    if (!list && ab_name_a && ab_name_b)
+    {
+        auto find_case = [] (std::string_view name) -> const benchmark_case* {
+            for (const auto& set : benchmark_sets())
+                for (const auto& benchmark : set.cases)
+                    if (set.description + '/' + benchmark.description == name)
+                        return &benchmark;
+
+            return nullptr;
+        };
+
+        // Both are called through the same kind of std::function, so that neither gets a head start.
+        auto state_func = [] (const benchmark_case& benchmark) -> std::function<void(benchmark_state&)> {
+            if (benchmark.state_func)
+                return benchmark.state_func;
+
+            return [&benchmark] (benchmark_state&) { benchmark.func(); };
+        };
+
+        const auto* case_a = find_case(*ab_name_a);
+        const auto* case_b = find_case(*ab_name_b);
+
+        if (!case_a || !case_b)
+        {
+            std::cerr << "Unknown benchmark '" << (case_a ? *ab_name_b : *ab_name_a) << "' for --a and --b\n";
+            return 1;
+        }
+
+        // Each case keeps its own setup, teardown and internal count, so that differently registered
+        // cases are compared per iteration.
+        auto options_a = with_args(case_a->options);
+        auto options_b = with_args(case_b->options);
+        options_a.cold_cache = cache == "cold";
+        options_b.cold_cache = cache == "cold";
+
+        ab = jg::benchmark_ab(*ab_name_a, state_func(*case_a), options_a, *ab_name_b, state_func(*case_b), options_b);
+        results = {ab->a, ab->b};
+    }
+    else
+    {
+        for (const auto& set : benchmark_sets())
+        {
+            for (const auto& benchmark : set.cases)
+            {
+                const std::string name = set.description + '/' + benchmark.description;
+
+                if (name.find(filter) == std::string::npos)
+                    continue;
+
+                if (list)
+                {
+                    std::cout << name << '\n';
+                    continue;
+                }
+
+                auto options = with_args(benchmark.options);
+
+                auto measure = [&] (const std::string& description) -> std::vector<benchmark_result> {
+                    if (rate && *rate > 0)
+                    {
+                        jg::load_options load_options;
+                        load_options.rate = *rate;
+                        load_options.retain_samples = options.retain_samples;
+
+                        if (min_time_ms)
+                            load_options.duration = std::chrono::milliseconds{*min_time_ms};
+
+                        // Pausing doesn't apply to open loop latency, so the state's timer isn't used.
+                        jg::detail::sample_timer timer{false};
+                        jg::benchmark_state state{timer};
+                        auto load = benchmark.state_func ? jg::benchmark_load(description, load_options, [&] { benchmark.state_func(state); })
+                                                         : jg::benchmark_load(description, load_options, benchmark.func);
+                        return {std::move(load.latency), std::move(load.service_time)};
+                    }
+                    else if (benchmark.state_func)
+                        return {jg::benchmark(description, options, benchmark.state_func)};
+                    else
+                        return {jg::benchmark(description, options, benchmark.func)};
+                };
+
+                auto run = [&] (const std::string& description) {
+                    if (!isolate)
+                    {
+                        for (auto& result : measure(description))
+                            results.push_back(std::move(result));
+                    }
+                    else if (auto isolated = jg::benchmark_isolated([&] { return measure(description); }))
+                    {
+                        for (auto& result : *isolated)
+                            results.push_back(std::move(result));
+                    }
+                    else
+                    {
+                        std::cerr << "Benchmark '" << name << "' failed in its child process\n";
+                        ++failed_count;
+                    }
+                };
+
+                // Results are named like `--filter` and `--list` name them, so that equally named cases of
+                // different sets don't get mixed up in baselines and histories.
+                if (cache != "cold")
+                    run(name);
+
+                if (cache != "warm")
+                {
+                    options.cold_cache = true;
+                    run(cache == "both" ? name + "/cold" : name);
+                }
+            }
+        }
+    }
+
+    if (list)
+        return 0;
+
+    std::ofstream output_file;
+
+    if (output_path)
+    {
+        output_file.open(std::string{*output_path});
+
+        if (!output_file)
+        {
+            std::cerr << "Can't write '" << *output_path << "'\n";
+            return 1;
+        }
+    }
+
+    std::ostream& output = output_path ? output_file : std::cout;
+
+    if (format == "json")
+        jg::write_json(output, results, environment);
+    else if (format == "csv")
+        jg::write_csv(output, results, environment);
+    else
+    {
+        jg::write_environment(output, environment);
+        jg::write_table(output, results);
+    }
+
+    if (ab)
+        jg::write_ab_comparison(format == "table" ? output : std::cerr, *ab);
+
+    if (history_path && !jg::append_benchmark_history(std::string{*history_path},
+                                                      jg::benchmark_history_records(results, commit ? std::string{*commit} : jg::current_git_commit(), environment)))
+    {
+        std::cerr << "Can't write history '" << *history_path << "'\n";
+        return 1;
+    }
+
+    if (!baseline_path)
+        return failed_count > 0 ? 1 : 0;
+
+    std::ifstream baseline_file{std::string{*baseline_path}};
+    const std::string baseline_document{std::istreambuf_iterator<char>(baseline_file), std::istreambuf_iterator<char>()};
+    std::istringstream baseline_stream{baseline_document};
+    const auto baseline = jg::read_benchmark_results(baseline_stream);
+
+    if (!baseline)
+    {
+        std::cerr << "Can't read baseline '" << *baseline_path << "'\n";
+        return 1;
+    }
+
+    std::istringstream baseline_environment_stream{baseline_document};
+
+    if (const auto baseline_environment = jg::read_benchmark_environment(baseline_environment_stream))
+        for (const auto& difference : jg::benchmark_environment_differences(*baseline_environment, environment))
+            std::cerr << "Warning: The baseline environment differs, " << difference << ".\n";
+
+    jg::benchmark_comparison_options options;
+    options.threshold = threshold.value_or(5) / 100;
+
+    const auto comparisons = jg::compare(*baseline, results, options);
+    jg::write_comparison(std::cout, comparisons);
+
+    if (const auto untested = jg::untested_count(comparisons); untested > 0)
+        std::cerr << untested << " benchmark(s) have no samples to compare with the baseline. Run without --no-samples, and with a baseline that has samples.\n";
+
+    return jg::regression_count(comparisons) > 0 || jg::untested_count(comparisons) > 0 || failed_count > 0 ? 1 : 0;
+}
+
+} // namespace jg
+
+#endif // #ifdef JG_BENCHMARK_IMPL
+#endif // #ifndef JG_BENCHMARK_INCLUDED
+
+#ifdef JG_BENCHMARK_MAIN
+int main(int argc, char** argv)
+{
+    return jg::benchmark_run({argc, argv});
+}
+#endif
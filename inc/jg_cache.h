@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "jg_string.h"
+
+namespace jg::detail {
+
+/// Parses a sysfs cache size, like "32K", "1024K" or "36M".
+inline std::optional<size_t> parse_cache_size(std::string_view text)
+{
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' '))
+        text.remove_suffix(1);
+
+    size_t multiplier = 1;
+
+    if (!text.empty() && (text.back() == 'K' || text.back() == 'M' || text.back() == 'G'))
+    {
+        multiplier = text.back() == 'K' ? size_t{1} << 10 : text.back() == 'M' ? size_t{1} << 20 : size_t{1} << 30;
+        text.remove_suffix(1);
+    }
+
+    if (text.find_first_not_of("0123456789") != std::string_view::npos)
+        return std::nullopt;
+
+    const auto size = jg::from_chars<size_t>(text);
+
+    if (!size || *size == 0)
+        return std::nullopt;
+
+    return *size * multiplier;
+}
+
+/// Twice the last level cache size, or 64 MiB if it isn't available. See `jg::cache_evictor`.
+inline size_t cache_evictor_buffer_size(std::optional<size_t> last_level_cache_size)
+{
+    return 2 * last_level_cache_size.value_or(size_t{32} << 20);
+}
+
+inline std::string read_first_line(const std::string& path)
+{
+    std::ifstream file{path};
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// The size in bytes of the highest level CPU cache of cpu0, read from sysfs on Linux.
+/// @returns `std::nullopt` if the size isn't available, like on other platforms than Linux.
+inline std::optional<size_t> last_level_cache_size()
+{
+#if defined(__linux__)
+    std::optional<size_t> size;
+    size_t highest_level = 0;
+
+    for (int index = 0; index < 16; ++index)
+    {
+        const std::string path = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + '/';
+        const auto level = jg::from_chars<size_t>(detail::read_first_line(path + "level"));
+
+        if (!level)
+            break;
+
+        if (detail::read_first_line(path + "type") == "Instruction" || *level < highest_level)
+            continue;
+
+        if (const auto index_size = detail::parse_cache_size(detail::read_first_line(path + "size")))
+        {
+            highest_level = *level;
+            size = index_size;
+        }
+    }
+
+    return size;
+#else
+    return std::nullopt;
+#endif
+}
+
+/// Evicts the CPU caches by incrementing a byte in every cache line of a buffer twice the size of the
+/// last level cache, or 64 MiB if the size isn't available. For measuring cold-cache performance.
+/// @note Only evicts the data caches of the calling core and the shared last level cache. The buffer
+/// is allocated once, in the constructor.
+///
+/// @example
+///     jg::cache_evictor evictor;
+///     evictor.evict();
+///     jg::stopwatch sw;
+///     first_call_of_the_day();
+class cache_evictor final
+{
+public:
+    cache_evictor()
+        : cache_evictor{detail::cache_evictor_buffer_size(last_level_cache_size())}
+    {}
+
+    explicit cache_evictor(size_t buffer_size)
+        : m_buffer(buffer_size)
+    {}
+
+    size_t buffer_size() const noexcept { return m_buffer.size(); }
+
+    void evict() noexcept
+    {
+        constexpr size_t cache_line_size = 64;
+        uint8_t sum = 0;
+
+        for (size_t i = 0; i < m_buffer.size(); i += cache_line_size)
+            sum = static_cast<uint8_t>(sum + ++m_buffer[i]);
+
+        m_sink = sum;
+    }
+
+private:
+    std::vector<uint8_t> m_buffer;
+    volatile uint8_t m_sink{};
+};
+
+} // namespace jg
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include "jg_stopwatch.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+/// @file Stopwatches that measure CPU time instead of wall time, and a measurement of wall, user and
+/// system time and context switches together, to tell code that computes from code that is blocked.
+
+namespace jg::detail {
+
+#if defined(_WIN32)
+inline int64_t filetime_ticks(const FILETIME& time) noexcept
+{
+    return static_cast<int64_t>((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime);
+}
+#else
+inline int64_t clock_ns(clockid_t clock) noexcept
+{
+    timespec time{};
+    clock_gettime(clock, &time);
+    return static_cast<int64_t>(time.tv_sec) * 1'000'000'000 + time.tv_nsec;
+}
+
+inline int64_t timeval_ns(const timeval& time) noexcept
+{
+    return static_cast<int64_t>(time.tv_sec) * 1'000'000'000 + static_cast<int64_t>(time.tv_usec) * 1'000;
+}
+#endif
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// CPU time of the calling thread, user and system, from `CLOCK_THREAD_CPUTIME_ID`. Only meaningful
+/// when the stopwatch is used on the thread that created it.
+struct thread_cpu_ticks final
+{
+#if defined(_WIN32)
+    static int64_t now() noexcept
+    {
+        FILETIME creation, exit, kernel, user;
+        GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+        return detail::filetime_ticks(kernel) + detail::filetime_ticks(user);
+    }
+
+    static double ns_per_tick() noexcept { return 100; }
+#else
+    static int64_t now() noexcept { return detail::clock_ns(CLOCK_THREAD_CPUTIME_ID); }
+    static double ns_per_tick() noexcept { return 1; }
+#endif
+};
+
+/// CPU time of all threads of the process, user and system, from `CLOCK_PROCESS_CPUTIME_ID`.
+struct process_cpu_ticks final
+{
+#if defined(_WIN32)
+    static int64_t now() noexcept
+    {
+        FILETIME creation, exit, kernel, user;
+        GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+        return detail::filetime_ticks(kernel) + detail::filetime_ticks(user);
+    }
+
+    static double ns_per_tick() noexcept { return 100; }
+#else
+    static int64_t now() noexcept { return detail::clock_ns(CLOCK_PROCESS_CPUTIME_ID); }
+    static double ns_per_tick() noexcept { return 1; }
+#endif
+};
+
+/// @example
+///     jg::thread_cpu_stopwatch cpu;
+///     jg::stopwatch wall;
+///     handle_request();
+///     std::cout << "on CPU " << cpu.ns() << " of " << wall.ns() << " ns\n";
+using thread_cpu_stopwatch = basic_stopwatch<thread_cpu_ticks>;
+using process_cpu_stopwatch = basic_stopwatch<process_cpu_ticks>;
+
+/// Wall time, CPU time split in user and system time, and context switches, all measured over the same
+/// interval.
+struct cpu_usage final
+{
+    std::chrono::nanoseconds::rep wall_ns{};
+    std::chrono::nanoseconds::rep user_ns{};
+    std::chrono::nanoseconds::rep system_ns{};
+    int64_t voluntary_context_switches{};   // Blocking, like waiting for I/O or a lock. 0 on Windows.
+    int64_t involuntary_context_switches{}; // Preempted by the scheduler. 0 on Windows.
+};
+
+enum class cpu_usage_scope
+{
+    thread,  // The calling thread. On macOS, where the thread usage isn't available, the process.
+    process
+};
+
+/// The `cpu_usage` since construction, or since the last `restart()`. Code that computes has a CPU time
+/// (user + system) close to the wall time, and code that is blocked has voluntary context switches and
+/// a wall time well above the CPU time.
+///
+/// @example
+///     jg::cpu_usage_stopwatch usage;
+///     flush_log_file();
+///     const auto u = usage.usage();
+///     std::cout << u.wall_ns << " ns wall, " << u.user_ns + u.system_ns << " ns CPU, "
+///               << u.voluntary_context_switches << " voluntary context switches\n";
+class cpu_usage_stopwatch final
+{
+public:
+    explicit cpu_usage_stopwatch(cpu_usage_scope scope = cpu_usage_scope::thread) noexcept
+        : m_scope{scope}
+        , m_start{now(scope)}
+    {}
+
+    cpu_usage usage() const noexcept
+    {
+        const auto end = now(m_scope);
+        return {end.wall_ns - m_start.wall_ns,
+                end.user_ns - m_start.user_ns,
+                end.system_ns - m_start.system_ns,
+                end.voluntary_context_switches - m_start.voluntary_context_switches,
+                end.involuntary_context_switches - m_start.involuntary_context_switches};
+    }
+
+    void restart() noexcept { m_start = now(m_scope); }
+
+private:
+    static cpu_usage now(cpu_usage_scope scope) noexcept
+    {
+        cpu_usage usage;
+        usage.wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+#if defined(_WIN32)
+        FILETIME creation, exit, kernel, user;
+
+        if (scope == cpu_usage_scope::thread)
+            GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+        else
+            GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+
+        usage.user_ns = detail::filetime_ticks(user) * 100;
+        usage.system_ns = detail::filetime_ticks(kernel) * 100;
+#else
+        rusage resources{};
+#if defined(RUSAGE_THREAD)
+        getrusage(scope == cpu_usage_scope::thread ? RUSAGE_THREAD : RUSAGE_SELF, &resources);
+#else
+        (void)scope;
+        getrusage(RUSAGE_SELF, &resources);
+#endif
+        usage.user_ns = detail::timeval_ns(resources.ru_utime);
+        usage.system_ns = detail::timeval_ns(resources.ru_stime);
+        usage.voluntary_context_switches = static_cast<int64_t>(resources.ru_nvcsw);
+        usage.involuntary_context_switches = static_cast<int64_t>(resources.ru_nivcsw);
+#endif
+
+        return usage;
+    }
+
+    cpu_usage_scope m_scope;
+    cpu_usage m_start;
+};
+
+} // namespace jg
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace jg {
+
+/// Serialized reads of the CPU time stamp counter (TSC), for timing operations that are too short for
+/// `jg::stopwatch`. `start()` is `lfence; rdtsc` and `stop()` is `rdtscp; lfence`, so the timed code
+/// can't be reordered to before `start()` or after `stop()`. On CPUs other than x86, the "cycles" are
+/// nanoseconds from `std::chrono::steady_clock`.
+///
+/// @note On CPUs with invariant TSC (all x86 CPUs of the last decade) the TSC ticks at a constant rate,
+/// regardless of frequency scaling. The cycles are then reference cycles, not core clock cycles.
+///
+/// @example
+///     const auto start = jg::cycle_clock::start();
+///     op();
+///     const auto cycles = jg::cycle_clock::stop() - start - jg::cycle_clock_overhead();
+///     std::cout << cycles * jg::cycle_clock_ns_per_cycle() << " ns\n";
+struct cycle_clock final
+{
+    static constexpr bool is_tsc() noexcept
+    {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static uint64_t start() noexcept
+    {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        _mm_lfence();
+        return __rdtsc();
+#else
+        return steady_ns();
+#endif
+    }
+
+    static uint64_t stop() noexcept
+    {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        unsigned int aux;
+        const uint64_t cycles = __rdtscp(&aux);
+        _mm_lfence();
+        return cycles;
+#else
+        return steady_ns();
+#endif
+    }
+
+private:
+    [[maybe_unused]] static uint64_t steady_ns() noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+};
+
+/// The nanoseconds per `cycle_clock` cycle. Calibrated against `std::chrono::steady_clock` on the first
+/// call, which busy-waits for about 20 ms.
+inline double cycle_clock_ns_per_cycle()
+{
+    static const double ns_per_cycle = []
+    {
+        if (!cycle_clock::is_tsc())
+            return 1.0;
+
+        using clock = std::chrono::steady_clock;
+
+        const auto first_time = clock::now();
+        const auto first_cycles = cycle_clock::start();
+        auto last_time = first_time;
+
+        while (last_time - first_time < std::chrono::milliseconds{20})
+            last_time = clock::now();
+
+        const auto last_cycles = cycle_clock::stop();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(last_time - first_time).count();
+
+        return last_cycles > first_cycles ? static_cast<double>(ns) / static_cast<double>(last_cycles - first_cycles) : 1.0;
+    }();
+
+    return ns_per_cycle;
+}
+
+/// The cycles measured between a `cycle_clock::start()` and a `cycle_clock::stop()` with nothing in
+/// between, which is what to subtract from a measurement to get the cycles of the timed code. The
+/// smallest of many measurements, taken on the first call.
+inline uint64_t cycle_clock_overhead()
+{
+    static const uint64_t overhead = []
+    {
+        uint64_t smallest = std::numeric_limits<uint64_t>::max();
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            const auto start = cycle_clock::start();
+            smallest = std::min(smallest, cycle_clock::stop() - start);
+        }
+
+        return smallest;
+    }();
+
+    return overhead;
+}
+
+} // namespace jg
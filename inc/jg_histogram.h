@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include "jg_verify.h"
+
+namespace jg::detail {
+
+inline unsigned highest_bit(uint64_t value) noexcept
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// HDR-style (High Dynamic Range) histogram of non-negative integer values, like latencies in nanoseconds.
+///
+/// Values are counted in log-linear buckets: values below 2^`sub_bucket_bits` are counted exactly, and
+/// each power-of-two range above that is split into 2^(`sub_bucket_bits` - 1) equally wide buckets. This
+/// keeps the relative error of any reported value below 2^-(`sub_bucket_bits` - 1) over the full 64-bit
+/// range, with amortized O(1) `record()`. The counts are allocated up to the bucket of the largest value
+/// recorded so far, so that a histogram is cheap to create and small for small values, and never exceeds
+/// 7424 counts for the default 8 bits.
+///
+/// Histograms with the same `sub_bucket_bits` can be merged, for instance one histogram per thread that
+/// are merged when the threads are done.
+///
+/// @example
+///     jg::histogram latencies;
+///     for (...)
+///         latencies.record(sw.ns());
+///     std::cout << "p99: " << latencies.value_at_percentile(99) << " ns\n";
+class histogram final
+{
+public:
+    explicit histogram(unsigned sub_bucket_bits = 8)
+        : m_sub_bucket_bits{sub_bucket_bits}
+    {
+        jg::verify(sub_bucket_bits >= 2 && sub_bucket_bits <= 16);
+    }
+
+    void record(uint64_t value, uint64_t count = 1)
+    {
+        const size_t index = index_of(value);
+
+        if (index >= m_counts.size())
+            m_counts.resize(index + 1);
+
+        m_counts[index] += count;
+        m_total_count += count;
+        m_sum += static_cast<double>(value) * static_cast<double>(count);
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+
+    void merge(const histogram& other)
+    {
+        jg::verify(other.m_sub_bucket_bits == m_sub_bucket_bits);
+
+        if (other.m_counts.size() > m_counts.size())
+            m_counts.resize(other.m_counts.size());
+
+        for (size_t i = 0; i < other.m_counts.size(); ++i)
+            m_counts[i] += other.m_counts[i];
+
+        m_total_count += other.m_total_count;
+        m_sum += other.m_sum;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    /// Keeps the allocated counts, for reuse.
+    void reset() noexcept
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_total_count = 0;
+        m_sum = 0;
+        m_min = std::numeric_limits<uint64_t>::max();
+        m_max = 0;
+    }
+
+    unsigned sub_bucket_bits() const noexcept { return m_sub_bucket_bits; }
+    uint64_t count() const noexcept { return m_total_count; }
+    bool empty() const noexcept { return m_total_count == 0; }
+
+    /// The exact smallest and largest recorded values. 0 if empty.
+    uint64_t min() const noexcept { return empty() ? 0 : m_min; }
+    uint64_t max() const noexcept { return m_max; }
+
+    /// The exact mean of the recorded values. 0 if empty.
+    double mean() const noexcept { return empty() ? 0.0 : m_sum / static_cast<double>(m_total_count); }
+
+    /// The standard deviation of the recorded values, as represented by their buckets. 0 if empty.
+    double std_deviation() const noexcept
+    {
+        if (empty())
+            return 0.0;
+
+        const double mean = this->mean();
+        double sum_squares = 0;
+
+        for_each_bucket([&] (uint64_t value, uint64_t count) {
+            const double diff = static_cast<double>(value) - mean;
+            sum_squares += diff * diff * static_cast<double>(count);
+        });
+
+        return std::sqrt(sum_squares / static_cast<double>(m_total_count));
+    }
+
+    /// The value that `percentile` percent of the recorded values are less than or equal to, within
+    /// the precision of the buckets. `percentile` is clamped to [0, 100]. 0 if empty.
+    uint64_t value_at_percentile(double percentile) const noexcept
+    {
+        if (empty())
+            return 0;
+
+        percentile = std::min(std::max(percentile, 0.0), 100.0);
+        const auto target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100 * static_cast<double>(m_total_count))));
+        uint64_t seen = 0;
+
+        for (size_t i = 0; i < m_counts.size(); ++i)
+        {
+            seen += m_counts[i];
+
+            if (seen >= target)
+                return std::min(std::max(highest_equivalent(i), m_min), m_max);
+        }
+
+        return m_max;
+    }
+
+    /// Calls `func(value, count)` for each non-empty bucket in increasing order, where `value` is the middle
+    /// of the bucket, clamped to the recorded min and max.
+    template <typename Func>
+    void for_each_bucket(Func&& func) const
+    {
+        for (size_t i = 0; i < m_counts.size(); ++i)
+            if (m_counts[i] > 0)
+                func(std::min(std::max(lowest_equivalent(i) + (highest_equivalent(i) - lowest_equivalent(i)) / 2, m_min), m_max), m_counts[i]);
+    }
+
+private:
+    size_t index_of(uint64_t value) const noexcept
+    {
+        const uint64_t sub_bucket_count = uint64_t{1} << m_sub_bucket_bits;
+
+        if (value < sub_bucket_count)
+            return static_cast<size_t>(value);
+
+        const unsigned group = detail::highest_bit(value) - m_sub_bucket_bits + 1;
+        const uint64_t half_count = sub_bucket_count / 2;
+
+        return static_cast<size_t>(sub_bucket_count + (group - 1) * half_count + ((value >> group) - half_count));
+    }
+
+    uint64_t lowest_equivalent(size_t index) const noexcept
+    {
+        const uint64_t sub_bucket_count = uint64_t{1} << m_sub_bucket_bits;
+
+        if (index < sub_bucket_count)
+            return index;
+
+        const uint64_t half_count = sub_bucket_count / 2;
+        const uint64_t group = (index - sub_bucket_count) / half_count + 1;
+        const uint64_t offset = (index - sub_bucket_count) % half_count;
+
+        return (half_count + offset) << group;
+    }
+
+    uint64_t highest_equivalent(size_t index) const noexcept
+    {
+        const uint64_t sub_bucket_count = uint64_t{1} << m_sub_bucket_bits;
+
+        if (index < sub_bucket_count)
+            return index;
+
+        const uint64_t group = (index - sub_bucket_count) / (sub_bucket_count / 2) + 1;
+
+        return lowest_equivalent(index) + ((uint64_t{1} << group) - 1);
+    }
+
+    unsigned m_sub_bucket_bits;
+    std::vector<uint64_t> m_counts;
+    uint64_t m_total_count{};
+    double m_sum{};
+    uint64_t m_min{std::numeric_limits<uint64_t>::max()};
+    uint64_t m_max{};
+};
+
+} // namespace jg
@@ -0,0 +1,449 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "jg_verify.h"
+
+/// @file Counters, gauges and histograms that are cheap to update from many threads, and export of their
+/// values in the Prometheus text format, to a string or a file, without a server.
+
+namespace jg::detail {
+
+/// Updates from different threads go to different shards, each on its own cache line, so that threads
+/// that update the same metric don't contend for the cache line. Reads sum the shards.
+constexpr size_t metric_shard_count = 16;
+
+inline size_t metric_shard_index() noexcept
+{
+    static std::atomic<size_t> next_index{};
+    thread_local const size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % metric_shard_count;
+    return index;
+}
+
+inline void atomic_add(std::atomic<double>& value, double increment) noexcept
+{
+    double expected = value.load(std::memory_order_relaxed);
+    while (!value.compare_exchange_weak(expected, expected + increment, std::memory_order_relaxed))
+        ;
+}
+
+inline bool valid_metric_name(std::string_view name) noexcept
+{
+    auto valid = [] (char c, bool first) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' || (!first && c >= '0' && c <= '9');
+    };
+
+    if (name.empty())
+        return false;
+
+    for (size_t i = 0; i < name.size(); ++i)
+        if (!valid(name[i], i == 0))
+            return false;
+
+    return true;
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// A value that only increases, like the number of handled requests.
+class metric_counter final
+{
+public:
+    void increment(uint64_t count = 1) noexcept
+    {
+        m_shards[detail::metric_shard_index()].value.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const noexcept
+    {
+        uint64_t sum = 0;
+
+        for (const auto& shard : m_shards)
+            sum += shard.value.load(std::memory_order_relaxed);
+
+        return sum;
+    }
+
+private:
+    struct alignas(64) shard final
+    {
+        std::atomic<uint64_t> value{};
+    };
+
+    std::array<shard, detail::metric_shard_count> m_shards{};
+};
+
+/// A value that goes up and down, like a queue depth. `add()` is sharded on top of the last set value.
+/// `set()` overwrites the value for all threads, so it takes a lock and is slower. An `add()` that is
+/// concurrent with a `set()` may or may not be included in the value.
+class metric_gauge final
+{
+public:
+    void set(double value) noexcept
+    {
+        std::lock_guard lock{m_set_mutex};
+
+        for (auto& shard : m_shards)
+            shard.value.store(0, std::memory_order_relaxed);
+
+        m_base.store(value, std::memory_order_relaxed);
+    }
+
+    void add(double increment) noexcept
+    {
+        detail::atomic_add(m_shards[detail::metric_shard_index()].value, increment);
+    }
+
+    double value() const noexcept
+    {
+        double sum = m_base.load(std::memory_order_relaxed);
+
+        for (const auto& shard : m_shards)
+            sum += shard.value.load(std::memory_order_relaxed);
+
+        return sum;
+    }
+
+private:
+    struct alignas(64) shard final
+    {
+        std::atomic<double> value{};
+    };
+
+    std::array<shard, detail::metric_shard_count> m_shards{};
+    std::atomic<double> m_base{};
+    std::mutex m_set_mutex;
+};
+
+struct metric_histogram_values final
+{
+    std::vector<double> upper_bounds;     // Ascending, without the implicit +Inf bucket.
+    std::vector<uint64_t> bucket_counts;  // Per bucket, not cumulative, with the +Inf bucket last.
+    uint64_t count{};
+    double sum{};
+};
+
+/// Counts observations, like request latencies in seconds, in buckets with fixed upper bounds.
+class metric_histogram final
+{
+public:
+    explicit metric_histogram(std::vector<double> upper_bounds)
+        : m_upper_bounds{std::move(upper_bounds)}
+        , m_lines_per_shard{(m_upper_bounds.size() + 1 + counts_per_line - 1) / counts_per_line}
+        , m_count_lines{std::make_unique<count_line[]>(detail::metric_shard_count * m_lines_per_shard)}
+    {
+        jg::verify(std::is_sorted(m_upper_bounds.begin(), m_upper_bounds.end()));
+    }
+
+    void observe(double value) noexcept
+    {
+        const auto bucket = static_cast<size_t>(std::lower_bound(m_upper_bounds.begin(), m_upper_bounds.end(), value) - m_upper_bounds.begin());
+        const size_t shard = detail::metric_shard_index();
+        count(shard, bucket).fetch_add(1, std::memory_order_relaxed);
+        detail::atomic_add(m_shards[shard].sum, value);
+    }
+
+    metric_histogram_values values() const
+    {
+        metric_histogram_values values;
+        values.upper_bounds = m_upper_bounds;
+        values.bucket_counts.resize(m_upper_bounds.size() + 1);
+
+        for (size_t shard = 0; shard < detail::metric_shard_count; ++shard)
+        {
+            for (size_t i = 0; i < values.bucket_counts.size(); ++i)
+                values.bucket_counts[i] += count(shard, i).load(std::memory_order_relaxed);
+
+            values.sum += m_shards[shard].sum.load(std::memory_order_relaxed);
+        }
+
+        for (const auto count : values.bucket_counts)
+            values.count += count;
+
+        return values;
+    }
+
+private:
+    static constexpr size_t counts_per_line = 64 / sizeof(std::atomic<uint64_t>);
+
+    // The bucket counts of all shards are in one block of cache lines, with each shard's counts starting
+    // on a line of its own, so that no line is shared between shards.
+    struct alignas(64) count_line final
+    {
+        std::atomic<uint64_t> counts[counts_per_line];
+    };
+
+    struct alignas(64) shard final
+    {
+        std::atomic<double> sum{};
+    };
+
+    std::atomic<uint64_t>& count(size_t shard, size_t bucket) const noexcept
+    {
+        return m_count_lines[shard * m_lines_per_shard + bucket / counts_per_line].counts[bucket % counts_per_line];
+    }
+
+    const std::vector<double> m_upper_bounds;
+    const size_t m_lines_per_shard;
+    const std::unique_ptr<count_line[]> m_count_lines;
+    std::array<shard, detail::metric_shard_count> m_shards{};
+};
+
+/// Upper bounds from `start`, each `factor` times the previous, like 0.001, 0.002, 0.004, ...
+inline std::vector<double> exponential_buckets(double start, double factor, size_t count)
+{
+    jg::verify(start > 0 && factor > 1);
+
+    std::vector<double> bounds;
+
+    for (double bound = start; bounds.size() < count; bound *= factor)
+        bounds.push_back(bound);
+
+    return bounds;
+}
+
+enum class metric_type
+{
+    counter,
+    gauge,
+    histogram
+};
+
+constexpr const char* to_string(metric_type type) noexcept
+{
+    switch (type)
+    {
+        case metric_type::counter:   return "counter";
+        case metric_type::gauge:     return "gauge";
+        case metric_type::histogram: return "histogram";
+        default:                     return "<unknown>";
+    }
+}
+
+struct metric_snapshot final
+{
+    std::string name;
+    std::string help;
+    metric_type type{};
+    double value{};                    // Of counters and gauges.
+    metric_histogram_values histogram; // Of histograms.
+};
+
+/// Named metrics, created on first use. References to the metrics stay valid for the lifetime of the
+/// registry, so hot code looks a metric up once and keeps the reference.
+///
+/// @example
+///     static auto& requests = jg::metrics().counter("requests_total", "Handled requests.");
+///     static auto& latency = jg::metrics().histogram("request_seconds", jg::exponential_buckets(0.0001, 2, 16));
+///     requests.increment();
+///     latency.observe(sw.ns() / 1e9);
+///     ...
+///     jg::write_prometheus_file("/var/lib/node_exporter/app.prom", jg::metrics().snapshot());
+class metrics_registry final
+{
+public:
+    metric_counter& counter(std::string_view name, std::string_view help = {})
+    {
+        return add<metric_counter>(m_counters, name, help, metric_type::counter);
+    }
+
+    metric_gauge& gauge(std::string_view name, std::string_view help = {})
+    {
+        return add<metric_gauge>(m_gauges, name, help, metric_type::gauge);
+    }
+
+    /// `upper_bounds` are only used when the histogram is created.
+    metric_histogram& histogram(std::string_view name, std::vector<double> upper_bounds, std::string_view help = {})
+    {
+        return add<metric_histogram>(m_histograms, name, help, metric_type::histogram, std::move(upper_bounds));
+    }
+
+    /// The current values of all metrics, in the order they were created. Each shard is read atomically,
+    /// but the metrics aren't read at the same instant.
+    std::vector<metric_snapshot> snapshot() const
+    {
+        std::lock_guard lock{m_mutex};
+        std::vector<metric_snapshot> snapshots;
+
+        for (const auto& entry : m_entries)
+        {
+            metric_snapshot snapshot{entry.name, entry.help, entry.type, 0, {}};
+
+            switch (entry.type)
+            {
+                case metric_type::counter:   snapshot.value = static_cast<double>(m_counters[entry.index]->value()); break;
+                case metric_type::gauge:     snapshot.value = m_gauges[entry.index]->value(); break;
+                case metric_type::histogram: snapshot.histogram = m_histograms[entry.index]->values(); break;
+            }
+
+            snapshots.push_back(std::move(snapshot));
+        }
+
+        return snapshots;
+    }
+
+private:
+    struct entry final
+    {
+        std::string name;
+        std::string help;
+        metric_type type;
+        size_t index;
+    };
+
+    template <typename Metric, typename... Args>
+    Metric& add(std::vector<std::unique_ptr<Metric>>& metrics, std::string_view name, std::string_view help, metric_type type, Args&&... args)
+    {
+        jg::verify(detail::valid_metric_name(name));
+
+        std::lock_guard lock{m_mutex};
+
+        for (const auto& e : m_entries)
+        {
+            if (e.name == name)
+            {
+                jg::verify(e.type == type);
+                return *metrics[e.index];
+            }
+        }
+
+        metrics.push_back(std::make_unique<Metric>(std::forward<Args>(args)...));
+        m_entries.push_back({std::string{name}, std::string{help}, type, metrics.size() - 1});
+        return *metrics.back();
+    }
+
+    mutable std::mutex m_mutex;
+    std::vector<entry> m_entries;
+    std::vector<std::unique_ptr<metric_counter>> m_counters;
+    std::vector<std::unique_ptr<metric_gauge>> m_gauges;
+    std::vector<std::unique_ptr<metric_histogram>> m_histograms;
+};
+
+/// The process wide registry.
+inline metrics_registry& metrics()
+{
+    static metrics_registry registry;
+    return registry;
+}
+
+} // namespace jg
+
+namespace jg::detail {
+
+/// Writes the shortest of 15 and 17 significant digits that reads back as `value`, so that bounds like
+/// 0.1 aren't written as 0.10000000000000001, but no value changes in a round trip.
+inline void write_prometheus_value(std::ostream& stream, double value)
+{
+    if (std::isnan(value))
+        stream << "NaN";
+    else if (std::isinf(value))
+        stream << (value > 0 ? "+Inf" : "-Inf");
+    else
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+
+        if (std::strtod(buffer, nullptr) != value)
+            std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+
+        stream << buffer;
+    }
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// Writes `snapshots` in the Prometheus text exposition format, version 0.0.4.
+inline void write_prometheus(std::ostream& stream, const std::vector<metric_snapshot>& snapshots)
+{
+    for (const auto& s : snapshots)
+    {
+        if (!s.help.empty())
+        {
+            stream << "# HELP " << s.name << ' ';
+
+            for (const char c : s.help)
+                stream << (c == '\\' ? "\\\\" : c == '\n' ? "\\n" : std::string_view{&c, 1});
+
+            stream << '\n';
+        }
+
+        stream << "# TYPE " << s.name << ' ' << to_string(s.type) << '\n';
+
+        if (s.type != metric_type::histogram)
+        {
+            stream << s.name << ' ';
+            detail::write_prometheus_value(stream, s.value);
+            stream << '\n';
+            continue;
+        }
+
+        uint64_t cumulative = 0;
+
+        for (size_t i = 0; i < s.histogram.bucket_counts.size(); ++i)
+        {
+            cumulative += s.histogram.bucket_counts[i];
+            stream << s.name << "_bucket{le=\"";
+            detail::write_prometheus_value(stream, i < s.histogram.upper_bounds.size() ? s.histogram.upper_bounds[i]
+                                                                                      : std::numeric_limits<double>::infinity());
+            stream << "\"} " << cumulative << '\n';
+        }
+
+        stream << s.name << "_sum ";
+        detail::write_prometheus_value(stream, s.histogram.sum);
+        stream << '\n' << s.name << "_count " << s.histogram.count << '\n';
+    }
+}
+
+inline std::string to_prometheus(const std::vector<metric_snapshot>& snapshots)
+{
+    std::ostringstream stream;
+    write_prometheus(stream, snapshots);
+    return stream.str();
+}
+
+/// Writes `snapshots` to `path` through a temporary file that is renamed to `path`, so that a reader,
+/// like the textfile collector of the Prometheus node exporter, never sees a partially written file.
+/// @returns false if the file can't be written.
+inline bool write_prometheus_file(const std::string& path, const std::vector<metric_snapshot>& snapshots)
+{
+    const std::string temporary_path = path + ".tmp";
+
+    {
+        std::ofstream file{temporary_path};
+
+        if (!file)
+            return false;
+
+        write_prometheus(file, snapshots);
+
+        if (!file.flush())
+            return false;
+    }
+
+#if defined(_WIN32)
+    std::remove(path.c_str()); // Doesn't replace an existing file otherwise.
+#endif
+    return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+}
+
+} // namespace jg
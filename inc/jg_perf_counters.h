@@ -0,0 +1,243 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace jg {
+
+/// Raw event counts read from a `perf_counters` instance. Counts of events that couldn't be opened are 0.
+/// Counts of events that the kernel only counted part of the time, since there are more events than
+/// hardware counters, are scaled up to the whole time and marked `multiplexed`.
+struct perf_counter_values final
+{
+    uint64_t cycles{};
+    uint64_t instructions{};
+    uint64_t cache_references{};
+    uint64_t cache_misses{};
+    uint64_t branches{};
+    uint64_t branch_misses{};
+    uint64_t page_faults{};
+    bool multiplexed{}; // Some counts are scaled estimates.
+    bool unscheduled{}; // Some event was never counted, like when the NMI watchdog holds a counter.
+
+    perf_counter_values& operator+=(const perf_counter_values& other) noexcept
+    {
+        cycles           += other.cycles;
+        instructions     += other.instructions;
+        cache_references += other.cache_references;
+        cache_misses     += other.cache_misses;
+        branches         += other.branches;
+        branch_misses    += other.branch_misses;
+        page_faults      += other.page_faults;
+        multiplexed      |= other.multiplexed;
+        unscheduled      |= other.unscheduled;
+        return *this;
+    }
+};
+
+/// Per-iteration event counts and the ratios derived from them. A ratio is 0 if its denominator
+/// event couldn't be counted.
+struct perf_counter_stats final
+{
+    double cycles{};
+    double instructions{};
+    double cache_misses{};
+    double branch_misses{};
+    double page_faults{};
+    double instructions_per_cycle{};
+    double cache_miss_rate{};  // cache misses / cache references
+    double branch_miss_rate{}; // branch misses / branches
+    bool multiplexed{};        // The counts are estimates, scaled from the part of the time they were counted.
+};
+
+inline perf_counter_stats make_perf_counter_stats(const perf_counter_values& values, size_t iterations) noexcept
+{
+    auto ratio = [] (uint64_t numerator, uint64_t denominator) {
+        return denominator > 0 ? static_cast<double>(numerator) / static_cast<double>(denominator) : 0.0;
+    };
+
+    const auto n = static_cast<uint64_t>(iterations > 0 ? iterations : 1);
+
+    return {
+        ratio(values.cycles, n),
+        ratio(values.instructions, n),
+        ratio(values.cache_misses, n),
+        ratio(values.branch_misses, n),
+        ratio(values.page_faults, n),
+        ratio(values.instructions, values.cycles),
+        ratio(values.cache_misses, values.cache_references),
+        ratio(values.branch_misses, values.branches),
+        values.multiplexed
+    };
+}
+
+/// Counts hardware and software events for the calling thread with Linux `perf_event_open`.
+///
+/// The events are opened when the instance is constructed and are counted between `start()` and `stop()`.
+/// Opening an event fails when the kernel doesn't permit it (see /proc/sys/kernel/perf_event_paranoid),
+/// when running in a virtual machine without a virtual PMU, or when not running on Linux at all. Such
+/// events are left out, and if no event at all could be opened, `available()` returns false and
+/// `start()`/`stop()` are cheap no-ops returning zeroed values. An opened event can still go uncounted,
+/// when the PMU can't schedule the group, which `stop()` reports with `perf_counter_values::unscheduled`.
+///
+/// @example
+///     jg::perf_counters counters;
+///     counters.start();
+///     op();
+///     const auto values = counters.stop();
+///     std::cout << "IPC: " << double(values.instructions) / values.cycles << '\n';
+class perf_counters final
+{
+public:
+    perf_counters() noexcept
+    {
+        m_fds.fill(-1);
+
+#if defined(__linux__)
+        open(cycles,           PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open(instructions,     PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open(cache_references, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+        open(cache_misses,     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        open(branches,         PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+        open(branch_misses,    PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        open(page_faults,      PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+#endif
+    }
+
+    ~perf_counters()
+    {
+#if defined(__linux__)
+        for (int fd : m_fds)
+            if (fd != -1)
+                close(fd);
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    bool available() const noexcept { return m_leader != -1; }
+
+    void start() noexcept
+    {
+#if defined(__linux__)
+        if (!available())
+            return;
+
+        ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    perf_counter_values stop() noexcept
+    {
+        perf_counter_values values;
+
+#if defined(__linux__)
+        if (!available())
+            return values;
+
+        ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        values.cycles           = read_value(cycles, values);
+        values.instructions     = read_value(instructions, values);
+        values.cache_references = read_value(cache_references, values);
+        values.cache_misses     = read_value(cache_misses, values);
+        values.branches         = read_value(branches, values);
+        values.branch_misses    = read_value(branch_misses, values);
+        values.page_faults      = read_value(page_faults, values);
+#endif
+
+        return values;
+    }
+
+private:
+    enum event : size_t
+    {
+        cycles,
+        instructions,
+        cache_references,
+        cache_misses,
+        branches,
+        branch_misses,
+        page_faults,
+        event_count
+    };
+
+#if defined(__linux__)
+    void open(event index, uint32_t type, uint64_t config) noexcept
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = type;
+        attr.config         = config;
+        attr.disabled       = m_leader == -1 ? 1 : 0; // Members follow the leader.
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const auto fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, m_leader, 0));
+
+        if (fd == -1)
+            return;
+
+        m_fds[index] = fd;
+
+        if (m_leader == -1)
+            m_leader = fd;
+    }
+
+    /// The count since `start()`, scaled up if the event was only counted part of the time.
+    uint64_t read_value(event index, perf_counter_values& values) noexcept
+    {
+        struct
+        {
+            uint64_t value;
+            uint64_t time_enabled;
+            uint64_t time_running;
+        } reading{};
+
+        if (m_fds[index] == -1 || ::read(m_fds[index], &reading, sizeof(reading)) != sizeof(reading))
+            return 0;
+
+        // Resetting the count doesn't reset the times, so the times of this sample are the differences.
+        auto& previous = m_times[index];
+        const uint64_t enabled = reading.time_enabled - previous.enabled;
+        const uint64_t running = reading.time_running - previous.running;
+        previous = {reading.time_enabled, reading.time_running};
+
+        if (running == 0)
+        {
+            values.unscheduled |= enabled > 0;
+            return 0;
+        }
+
+        if (running >= enabled)
+            return reading.value;
+
+        values.multiplexed = true;
+        return static_cast<uint64_t>(static_cast<double>(reading.value) * static_cast<double>(enabled) / static_cast<double>(running));
+    }
+#endif
+
+    struct times final
+    {
+        uint64_t enabled;
+        uint64_t running;
+    };
+
+    std::array<int, event_count> m_fds;
+    std::array<times, event_count> m_times{};
+    int m_leader{-1};
+};
+
+} // namespace jg
@@ -0,0 +1,561 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "jg_source_location.h"
+#include "jg_stopwatch.h"
+
+/// @file Hierarchical profiling zones that are cheap enough to leave compiled in. Each thread aggregates
+/// its zones into a call tree as they are exited, in memory preallocated at the first zone, and the call
+/// trees of all threads are merged into a report on demand. While a trace is started, each thread also
+/// records its zones and counters as events in a preallocated buffer, which are exported as Chrome
+/// trace event JSON.
+
+namespace jg {
+
+/// A named place in the code. Defined by `jg_profile_scope()`, with static storage duration.
+struct profile_zone final
+{
+    const char* name;
+    jg::source_location location;
+};
+
+} // namespace jg
+
+namespace jg::detail {
+
+/// A zone in a particular call path. The owning thread writes the links and the counters, and a reader
+/// on another thread only reads the counters and the immutable `zone` and `parent` of the nodes that
+/// `profile_thread::node_count()` publishes.
+struct profile_node final
+{
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    const profile_zone* zone{};
+    uint32_t parent{none};
+    uint32_t first_child{none};
+    uint32_t next_sibling{none};
+    std::atomic<uint64_t> count{};
+    std::atomic<int64_t> inclusive_ticks{};
+    std::atomic<int64_t> child_ticks{};
+};
+
+struct trace_event final
+{
+    const char* name;
+    const profile_zone* zone; // Null for counters.
+    int64_t start;
+    int64_t duration;
+    double value;             // Of counters.
+};
+
+struct trace_state final
+{
+    std::atomic<bool> enabled{};
+    std::atomic<uint32_t> generation{}; // Incremented by each `start_trace()`.
+    std::atomic<int64_t> start{};
+    std::atomic<size_t> capacity{};
+};
+
+inline trace_state& trace()
+{
+    static trace_state state;
+    return state;
+}
+
+/// The call tree of one thread, with node 0 as the root above the outermost zones, and its trace events.
+class profile_thread final
+{
+public:
+    static constexpr uint32_t capacity = 1024; // Distinct call paths per thread.
+    static constexpr size_t max_depth = 128;   // Nested zones per thread.
+
+    explicit profile_thread(uint32_t id)
+        : m_id{id}
+        , m_nodes{new profile_node[capacity]}
+    {}
+
+    bool enter(const profile_zone& zone) noexcept
+    {
+        if (m_depth == max_depth)
+            return drop();
+
+        auto& current = m_nodes[m_current];
+        uint32_t node = current.first_child;
+
+        while (node != profile_node::none && m_nodes[node].zone != &zone)
+            node = m_nodes[node].next_sibling;
+
+        if (node == profile_node::none)
+        {
+            node = m_node_count.load(std::memory_order_relaxed);
+
+            if (node == capacity)
+                return drop();
+
+            m_nodes[node].zone = &zone;
+            m_nodes[node].parent = m_current;
+            m_nodes[node].next_sibling = current.first_child;
+            current.first_child = node;
+            m_node_count.store(node + 1, std::memory_order_release);
+        }
+
+        m_current = node;
+        m_stack[m_depth++] = {node, jg::cycle_ticks::now()};
+        return true;
+    }
+
+    void exit() noexcept
+    {
+        const auto end = jg::cycle_ticks::now();
+        const auto frame = m_stack[--m_depth];
+        const auto elapsed = end - frame.start;
+
+        // Single writer, so load + store instead of the locked read-modify-write of fetch_add.
+        auto& node = m_nodes[frame.node];
+        node.count.store(node.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        node.inclusive_ticks.store(node.inclusive_ticks.load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+
+        auto& parent = m_nodes[node.parent];
+        parent.child_ticks.store(parent.child_ticks.load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+
+        m_current = node.parent;
+
+        if (trace().enabled.load(std::memory_order_relaxed))
+            add_trace_event({node.zone->name, node.zone, frame.start, elapsed, 0});
+    }
+
+    void add_counter(const char* name, double value) noexcept
+    {
+        if (trace().enabled.load(std::memory_order_relaxed))
+            add_trace_event({name, nullptr, jg::cycle_ticks::now(), 0, value});
+    }
+
+    uint32_t id() const noexcept { return m_id; }
+    uint32_t node_count() const noexcept { return m_node_count.load(std::memory_order_acquire); }
+    const profile_node& node(uint32_t index) const noexcept { return m_nodes[index]; }
+    uint64_t dropped() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+
+    uint32_t trace_generation() const noexcept { return m_trace_generation.load(std::memory_order_acquire); }
+    size_t trace_event_count() const noexcept { return m_trace_event_count.load(std::memory_order_acquire); }
+    const trace_event& event(size_t index) const noexcept { return m_trace_events[index]; }
+    uint64_t dropped_trace_events() const noexcept { return m_dropped_trace_events.load(std::memory_order_relaxed); }
+
+    std::string name; // Guarded by `profile_threads_mutex()`.
+
+private:
+    bool drop() noexcept
+    {
+        m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void add_trace_event(const trace_event& event) noexcept
+    {
+        const auto& state = trace();
+        const auto generation = state.generation.load(std::memory_order_acquire);
+
+        if (event.start < state.start.load(std::memory_order_relaxed))
+            return;
+
+        // The first event of a new trace resets the buffer, growing it if the capacity has increased.
+        if (m_trace_generation.load(std::memory_order_relaxed) != generation)
+        {
+            if (const auto capacity = state.capacity.load(std::memory_order_relaxed); capacity > m_trace_capacity)
+            {
+                m_trace_events.reset(new (std::nothrow) trace_event[capacity]);
+                m_trace_capacity = m_trace_events ? capacity : 0;
+            }
+
+            m_trace_event_count.store(0, std::memory_order_relaxed);
+            m_dropped_trace_events.store(0, std::memory_order_relaxed);
+            m_trace_generation.store(generation, std::memory_order_release);
+        }
+
+        const auto count = m_trace_event_count.load(std::memory_order_relaxed);
+
+        if (count == m_trace_capacity)
+        {
+            m_dropped_trace_events.store(m_dropped_trace_events.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+
+        m_trace_events[count] = event;
+        m_trace_event_count.store(count + 1, std::memory_order_release);
+    }
+
+    struct frame final
+    {
+        uint32_t node;
+        int64_t start;
+    };
+
+    const uint32_t m_id;
+    std::unique_ptr<profile_node[]> m_nodes;
+    std::atomic<uint32_t> m_node_count{1};
+    std::atomic<uint64_t> m_dropped{};
+    std::array<frame, max_depth> m_stack{};
+    size_t m_depth{};
+    uint32_t m_current{};
+    std::unique_ptr<trace_event[]> m_trace_events;
+    size_t m_trace_capacity{};
+    std::atomic<size_t> m_trace_event_count{};
+    std::atomic<uint64_t> m_dropped_trace_events{};
+    std::atomic<uint32_t> m_trace_generation{};
+};
+
+inline std::mutex& profile_threads_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+/// All threads that have entered a zone, also after they have exited, so that their zones are reported.
+inline std::vector<std::shared_ptr<profile_thread>>& profile_threads()
+{
+    static std::vector<std::shared_ptr<profile_thread>> threads;
+    return threads;
+}
+
+inline profile_thread& this_profile_thread()
+{
+    thread_local const auto thread = []
+    {
+        std::lock_guard lock{profile_threads_mutex()};
+        auto t = std::make_shared<profile_thread>(static_cast<uint32_t>(profile_threads().size() + 1));
+        profile_threads().push_back(t);
+        return t;
+    }();
+
+    return *thread;
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// Enters `zone` on construction and exits it on destruction. Use `jg_profile_scope()` instead of using
+/// this class directly. A zone that is nested too deep, or that would need a node when the call tree of
+/// the thread is full, isn't measured and is counted in `profile_report::dropped_scopes` instead.
+class profile_scope final
+{
+public:
+    explicit profile_scope(const profile_zone& zone) noexcept
+        : m_thread{detail::this_profile_thread()}
+        , m_entered{m_thread.enter(zone)}
+    {}
+
+    ~profile_scope()
+    {
+        if (m_entered)
+            m_thread.exit();
+    }
+
+    profile_scope(const profile_scope&) = delete;
+    profile_scope& operator=(const profile_scope&) = delete;
+
+private:
+    detail::profile_thread& m_thread;
+    const bool m_entered;
+};
+
+struct profile_call_node final
+{
+    const profile_zone* zone{};
+    uint64_t count{};
+    std::chrono::nanoseconds::rep inclusive_ns{}; // Including the zones called from this one.
+    std::chrono::nanoseconds::rep exclusive_ns{}; // Excluding the zones called from this one.
+    std::vector<profile_call_node> children;      // Highest `inclusive_ns` first.
+};
+
+struct profile_report final
+{
+    std::vector<profile_call_node> roots; // Highest `inclusive_ns` first.
+    uint64_t dropped_scopes{};
+};
+
+} // namespace jg
+
+namespace jg::detail {
+
+inline void merge_profile_node(std::vector<profile_call_node>& siblings, const profile_thread& thread,
+                               const std::vector<std::vector<uint32_t>>& children, uint32_t index, double ns_per_tick)
+{
+    const auto& node = thread.node(index);
+
+    auto merged = std::find_if(siblings.begin(), siblings.end(), [&node] (const auto& s) { return s.zone == node.zone; });
+
+    if (merged == siblings.end())
+    {
+        siblings.push_back({node.zone, 0, 0, 0, {}});
+        merged = siblings.end() - 1;
+    }
+
+    const auto inclusive_ticks = node.inclusive_ticks.load(std::memory_order_relaxed);
+    const auto child_ticks = node.child_ticks.load(std::memory_order_relaxed);
+
+    merged->count += node.count.load(std::memory_order_relaxed);
+    merged->inclusive_ns += static_cast<std::chrono::nanoseconds::rep>(static_cast<double>(inclusive_ticks) * ns_per_tick);
+    merged->exclusive_ns += static_cast<std::chrono::nanoseconds::rep>(static_cast<double>(std::max<int64_t>(inclusive_ticks - child_ticks, 0)) * ns_per_tick);
+
+    // The recursion only changes the children of `merged`, so the reference stays valid.
+    auto& merged_children = merged->children;
+
+    for (const auto child : children[index])
+        merge_profile_node(merged_children, thread, children, child, ns_per_tick);
+}
+
+inline void sort_profile_nodes(std::vector<profile_call_node>& nodes)
+{
+    std::sort(nodes.begin(), nodes.end(), [] (const auto& n1, const auto& n2) { return n1.inclusive_ns > n2.inclusive_ns; });
+
+    for (auto& node : nodes)
+        sort_profile_nodes(node.children);
+}
+
+inline void write_profile_nodes(std::ostream& stream, const std::vector<profile_call_node>& nodes, size_t depth,
+                                size_t column1_width, double total_ns)
+{
+    for (const auto& node : nodes)
+    {
+        stream << std::setw(static_cast<int>(depth * 2)) << "" << std::setw(static_cast<int>(column1_width - depth * 2)) << std::left
+               << node.zone->name << std::right
+               << std::setw(12) << node.count
+               << std::setw(16) << node.inclusive_ns
+               << std::setw(16) << node.exclusive_ns
+               << std::setw(9) << (total_ns > 0 ? static_cast<double>(node.inclusive_ns) * 100 / total_ns : 0.0) << "%\n";
+
+        write_profile_nodes(stream, node.children, depth + 1, column1_width, total_ns);
+    }
+}
+
+inline size_t profile_name_width(const std::vector<profile_call_node>& nodes, size_t depth)
+{
+    size_t width = 0;
+
+    for (const auto& node : nodes)
+        width = std::max({width, depth * 2 + std::char_traits<char>::length(node.zone->name), profile_name_width(node.children, depth + 1)});
+
+    return width;
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// Merges the call trees of all threads that have entered a zone, by call path. Zones that are entered
+/// but not yet exited aren't included. Safe to call while other threads are in zones.
+inline profile_report profile_snapshot()
+{
+    std::vector<std::shared_ptr<detail::profile_thread>> threads;
+
+    {
+        std::lock_guard lock{detail::profile_threads_mutex()};
+        threads = detail::profile_threads();
+    }
+
+    const double ns_per_tick = jg::cycle_ticks::ns_per_tick();
+    profile_report report;
+
+    for (const auto& thread : threads)
+    {
+        const auto node_count = thread->node_count();
+        std::vector<std::vector<uint32_t>> children(node_count);
+
+        for (uint32_t i = 1; i < node_count; ++i)
+            children[thread->node(i).parent].push_back(i);
+
+        for (const auto root : children[0])
+            detail::merge_profile_node(report.roots, *thread, children, root, ns_per_tick);
+
+        report.dropped_scopes += thread->dropped();
+    }
+
+    detail::sort_profile_nodes(report.roots);
+    return report;
+}
+
+/// Writes `report` as an indented call tree, with the call count, the inclusive and exclusive times and
+/// the share of the total time of the roots.
+inline void write_profile(std::ostream& stream, const profile_report& report)
+{
+    const size_t column1_width = std::max<size_t>(detail::profile_name_width(report.roots, 0), 4) + 3;
+    double total_ns = 0;
+
+    for (const auto& root : report.roots)
+        total_ns += static_cast<double>(root.inclusive_ns);
+
+    const auto flags = stream.flags();
+    const auto precision = stream.precision(1);
+
+    stream << std::setw(static_cast<int>(column1_width)) << std::left << "zone" << std::right
+           << std::setw(12) << "calls" << std::setw(16) << "inclusive (ns)" << std::setw(16) << "exclusive (ns)" << std::setw(10) << "total"
+           << '\n' << std::fixed;
+
+    detail::write_profile_nodes(stream, report.roots, 0, column1_width, total_ns);
+
+    if (report.dropped_scopes > 0)
+        stream << report.dropped_scopes << " scopes weren't measured, because they were nested too deep or their thread's call tree was full.\n";
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+/// Names the calling thread in traces. The name is kept also after the thread has exited.
+inline void set_profile_thread_name(std::string name)
+{
+    auto& thread = detail::this_profile_thread();
+    std::lock_guard lock{detail::profile_threads_mutex()};
+    thread.name = std::move(name);
+}
+
+/// Starts recording the zones that are exited and the counters that are set on all threads, into
+/// buffers of `events_per_thread` events that each thread allocates at its first event. Events that
+/// don't fit are counted, not recorded. Discards the events of a previous trace.
+inline void start_trace(size_t events_per_thread = size_t{1} << 16)
+{
+    auto& state = detail::trace();
+    state.capacity.store(events_per_thread, std::memory_order_relaxed);
+    state.start.store(jg::cycle_ticks::now(), std::memory_order_relaxed);
+    state.generation.fetch_add(1, std::memory_order_release);
+    state.enabled.store(true, std::memory_order_release);
+}
+
+/// Stops recording, keeping the recorded events for `write_chrome_trace()`.
+inline void stop_trace()
+{
+    detail::trace().enabled.store(false, std::memory_order_release);
+}
+
+/// Records `value` of the counter `name`, on the calling thread, if a trace is started. `name` must
+/// outlive the trace, like a string literal. Shown as a graph per counter in the trace viewers.
+inline void trace_counter(const char* name, double value) noexcept
+{
+    detail::this_profile_thread().add_counter(name, value);
+}
+
+/// Writes the events of the current or last trace as Chrome trace event JSON, that chrome://tracing and
+/// https://ui.perfetto.dev load. Zones are complete ("X") events, which the viewers nest by time per
+/// thread, and counters are "C" events. Threads are named by `set_profile_thread_name()`. Safe to call
+/// during a trace, but not concurrently with `start_trace()`.
+inline void write_chrome_trace(std::ostream& stream)
+{
+    auto write_string = [&stream] (std::string_view string) {
+        stream << '"';
+
+        for (const char c : string)
+        {
+            if (c == '"' || c == '\\')
+                stream << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                stream << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xf] << "0123456789abcdef"[c & 0xf];
+            else
+                stream << c;
+        }
+
+        stream << '"';
+    };
+
+    std::vector<std::pair<std::shared_ptr<detail::profile_thread>, std::string>> threads;
+
+    {
+        std::lock_guard lock{detail::profile_threads_mutex()};
+
+        for (const auto& thread : detail::profile_threads())
+            threads.emplace_back(thread, thread->name);
+    }
+
+    const auto& state = detail::trace();
+    const auto generation = state.generation.load(std::memory_order_acquire);
+    const auto start = state.start.load(std::memory_order_relaxed);
+    const double us_per_tick = jg::cycle_ticks::ns_per_tick() / 1000;
+    uint64_t dropped = 0;
+    const char* separator = "\n";
+
+    const auto flags = stream.flags();
+    const auto precision = stream.precision(3);
+
+    stream << "{\"traceEvents\": [" << std::fixed;
+
+    for (const auto& [thread, name] : threads)
+    {
+        const auto tid = thread->id();
+
+        if (!name.empty())
+        {
+            stream << separator << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << tid << ", \"args\": {\"name\": ";
+            write_string(name);
+            stream << "}}";
+            separator = ",\n";
+        }
+
+        if (thread->trace_generation() != generation)
+            continue;
+
+        const auto count = thread->trace_event_count();
+        dropped += thread->dropped_trace_events();
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto& event = thread->event(i);
+
+            stream << separator << "{\"name\": ";
+            write_string(event.name);
+            stream << ", \"ph\": \"" << (event.zone ? 'X' : 'C') << "\", \"ts\": " << static_cast<double>(event.start - start) * us_per_tick;
+
+            if (event.zone)
+            {
+                stream << ", \"dur\": " << static_cast<double>(event.duration) * us_per_tick
+                       << ", \"pid\": 1, \"tid\": " << tid << ", \"args\": {\"file\": ";
+                write_string(event.zone->location.file_name() ? event.zone->location.file_name() : "");
+                stream << ", \"line\": " << event.zone->location.line() << "}}";
+            }
+            else
+                stream << ", \"pid\": 1, \"tid\": " << tid << ", \"args\": {\"value\": " << std::defaultfloat << std::setprecision(10) << event.value
+                       << std::fixed << std::setprecision(3) << "}}";
+
+            separator = ",\n";
+        }
+    }
+
+    stream << "\n], \"displayTimeUnit\": \"ns\", \"otherData\": {\"dropped_events\": " << dropped << "}}\n";
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+} // namespace jg
+
+#define jg_profile_concat_impl(a, b) a##b
+#define jg_profile_concat(a, b) jg_profile_concat_impl(a, b)
+
+/// Measures the rest of the enclosing scope as the zone `name`, which must be a string literal or
+/// otherwise outlive the program. Nested `jg_profile_scope()`s form a call tree, per thread, and are
+/// recorded as trace events between `jg::start_trace()` and `jg::stop_trace()`.
+///
+/// @example
+///     void handle_request(const request& r)
+///     {
+///         jg_profile_scope("handle_request");
+///         parse(r);      // has a jg_profile_scope("parse")
+///         respond(r);    // has a jg_profile_scope("respond")
+///     }
+///     ...
+///     jg::write_profile(std::cout, jg::profile_snapshot());
+#define jg_profile_scope(name) \
+    static const jg::profile_zone jg_profile_concat(jg_profile_zone_, __LINE__){name, jg_current_source_location()}; \
+    const jg::profile_scope jg_profile_concat(jg_profile_scope_, __LINE__){jg_profile_concat(jg_profile_zone_, __LINE__)}
@@ -0,0 +1,616 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "jg_span.h"
+#include "jg_verify.h"
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/// @file Sums, sums of squares, minimums and maximums, and mean and variance in one pass, of contiguous
+/// doubles and 64-bit integers, with AVX-512, AVX2 or NEON. On x86-64, the instruction set is picked at
+/// runtime from what the CPU supports, so the code doesn't have to be built with `-mavx2` to use it and
+/// still runs on CPUs without it. The floating point results differ from a sequential sum in the last
+/// bits, since the values are summed in several lanes and accumulators.
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define JG_REDUCE_X86 1
+#define JG_REDUCE_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define JG_REDUCE_X86 1
+#define JG_REDUCE_TARGET(isa)
+#endif
+
+namespace jg {
+
+enum class simd_level
+{
+    scalar,
+    neon,
+    avx2,
+    avx512
+};
+
+constexpr const char* to_string(simd_level level) noexcept
+{
+    switch (level)
+    {
+        case simd_level::scalar: return "scalar";
+        case simd_level::neon:   return "NEON";
+        case simd_level::avx2:   return "AVX2";
+        case simd_level::avx512: return "AVX-512";
+        default:                 return "<unknown>";
+    }
+}
+
+/// Doubles and signed 64-bit integers, like `std::chrono::nanoseconds::rep`.
+template <typename T>
+constexpr bool is_simd_reducible_v = std::is_same_v<T, double> || (std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 8);
+
+} // namespace jg
+
+namespace jg::detail {
+
+inline simd_level detect_simd_level() noexcept
+{
+#if defined(JG_REDUCE_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+
+    if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) // OSXSAVE and AVX
+        return simd_level::scalar;
+
+    const auto enabled_state = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+
+    if ((info[1] & (1 << 16)) && (enabled_state & 0xe6) == 0xe6) // AVX512F, and the ZMM state enabled by the OS
+        return simd_level::avx512;
+
+    if ((info[1] & (1 << 5)) && (enabled_state & 0x6) == 0x6) // AVX2, and the YMM state enabled by the OS
+        return simd_level::avx2;
+
+    return simd_level::scalar;
+#elif defined(JG_REDUCE_X86)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+        return simd_level::avx512;
+
+    if (__builtin_cpu_supports("avx2"))
+        return simd_level::avx2;
+
+    return simd_level::scalar;
+#elif defined(__aarch64__)
+    return simd_level::neon; // Always available on AArch64.
+#else
+    return simd_level::scalar;
+#endif
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// The widest instruction set that the reductions can use on this CPU, detected on the first call.
+inline simd_level detected_simd_level() noexcept
+{
+    static const simd_level level = detail::detect_simd_level();
+    return level;
+}
+
+/// Whether the reductions can be given `level` on this CPU.
+inline bool is_supported(simd_level level) noexcept
+{
+    const auto detected = detected_simd_level();
+    return level == simd_level::scalar || level == detected || (level == simd_level::avx2 && detected == simd_level::avx512);
+}
+
+} // namespace jg
+
+namespace jg::detail {
+
+/// Sums of `value - offset` and of `(value - offset)^2`, and the minimum and maximum value.
+struct square_sums final
+{
+    double sum{};
+    double sum_squares{};
+    double min{std::numeric_limits<double>::infinity()};
+    double max{-std::numeric_limits<double>::infinity()};
+};
+
+inline void combine(square_sums& sums, const square_sums& other) noexcept
+{
+    sums.sum += other.sum;
+    sums.sum_squares += other.sum_squares;
+    sums.min = std::min(sums.min, other.min);
+    sums.max = std::max(sums.max, other.max);
+}
+
+inline double sum_scalar(const double* data, size_t size) noexcept
+{
+    double sums[4]{};
+    size_t i = 0;
+
+    for (; i + 4 <= size; i += 4)
+        for (size_t lane = 0; lane < 4; ++lane)
+            sums[lane] += data[i + lane];
+
+    for (; i < size; ++i)
+        sums[0] += data[i];
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+// 64-bit integers are converted to doubles before they are offset, like in the vector kernels.
+template <typename T>
+square_sums square_sums_scalar(const T* data, size_t size, double offset) noexcept
+{
+    square_sums sums;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        const double value = static_cast<double>(data[i]);
+        const double deviation = value - offset;
+        sums.sum += deviation;
+        sums.sum_squares += deviation * deviation;
+        sums.min = std::min(sums.min, value);
+        sums.max = std::max(sums.max, value);
+    }
+
+    return sums;
+}
+
+// Wraps around on overflow, like the vector instructions, instead of being undefined.
+template <typename T>
+T sum_scalar(const T* data, size_t size) noexcept
+{
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < size; ++i)
+        sum += static_cast<uint64_t>(data[i]);
+
+    return static_cast<T>(sum);
+}
+
+template <typename T>
+std::pair<T, T> min_max_scalar(const T* data, size_t size, std::pair<T, T> min_max) noexcept
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        min_max.first = std::min(min_max.first, data[i]);
+        min_max.second = std::max(min_max.second, data[i]);
+    }
+
+    return min_max;
+}
+
+#if defined(JG_REDUCE_X86)
+
+JG_REDUCE_TARGET("avx2") inline double horizontal_sum(__m256d v) noexcept
+{
+    const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+JG_REDUCE_TARGET("avx2") inline double sum_avx2(const double* data, size_t size) noexcept
+{
+    __m256d sums[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16)
+        for (size_t lane = 0; lane < 4; ++lane)
+            sums[lane] = _mm256_add_pd(sums[lane], _mm256_loadu_pd(data + i + lane * 4));
+
+    return horizontal_sum(_mm256_add_pd(_mm256_add_pd(sums[0], sums[1]), _mm256_add_pd(sums[2], sums[3]))) + sum_scalar(data + i, size - i);
+}
+
+// There is no 64-bit integer to double conversion before AVX-512DQ. With the sign bit flipped, the value
+// is 2^63 more, as unsigned. Its high half is put in the mantissa of 2^84, its low half in the mantissa
+// of 2^52, and the exponents and the 2^63 are subtracted, with one rounding in the final addition.
+JG_REDUCE_TARGET("avx2") inline __m256d to_double_avx2(__m256i values) noexcept
+{
+    const __m256i flipped = _mm256_xor_si256(values, _mm256_set1_epi64x(std::numeric_limits<int64_t>::min()));
+    const __m256i high = _mm256_or_si256(_mm256_srli_epi64(flipped, 32), _mm256_castpd_si256(_mm256_set1_pd(0x1p84)));
+    const __m256i low = _mm256_blend_epi32(flipped, _mm256_castpd_si256(_mm256_set1_pd(0x1p52)), 0xaa);
+    return _mm256_add_pd(_mm256_sub_pd(_mm256_castsi256_pd(high), _mm256_set1_pd(0x1p84 + 0x1p63 + 0x1p52)), _mm256_castsi256_pd(low));
+}
+
+template <typename T>
+JG_REDUCE_TARGET("avx2") __m256d load_double_avx2(const T* data) noexcept
+{
+    if constexpr (std::is_same_v<T, double>)
+        return _mm256_loadu_pd(data);
+    else
+        return to_double_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)));
+}
+
+template <typename T>
+JG_REDUCE_TARGET("avx2") square_sums square_sums_avx2(const T* data, size_t size, double offset) noexcept
+{
+    const __m256d offsets = _mm256_set1_pd(offset);
+    __m256d sums[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256d squares[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256d min = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d max = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8)
+    {
+        for (size_t lane = 0; lane < 2; ++lane)
+        {
+            const __m256d values = load_double_avx2(data + i + lane * 4);
+            const __m256d deviations = _mm256_sub_pd(values, offsets);
+            sums[lane] = _mm256_add_pd(sums[lane], deviations);
+            squares[lane] = _mm256_add_pd(squares[lane], _mm256_mul_pd(deviations, deviations));
+            min = _mm256_min_pd(min, values);
+            max = _mm256_max_pd(max, values);
+        }
+    }
+
+    alignas(32) double mins[4];
+    alignas(32) double maxs[4];
+    _mm256_store_pd(mins, min);
+    _mm256_store_pd(maxs, max);
+
+    square_sums result;
+    result.sum = horizontal_sum(_mm256_add_pd(sums[0], sums[1]));
+    result.sum_squares = horizontal_sum(_mm256_add_pd(squares[0], squares[1]));
+    result.min = std::min({mins[0], mins[1], mins[2], mins[3]});
+    result.max = std::max({maxs[0], maxs[1], maxs[2], maxs[3]});
+    combine(result, square_sums_scalar(data + i, size - i, offset));
+    return result;
+}
+
+template <typename T>
+JG_REDUCE_TARGET("avx2") T sum_avx2(const T* data, size_t size) noexcept
+{
+    __m256i sums[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16)
+        for (size_t lane = 0; lane < 4; ++lane)
+            sums[lane] = _mm256_add_epi64(sums[lane], _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + lane * 4)));
+
+    alignas(32) T lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(_mm256_add_epi64(sums[0], sums[1]), _mm256_add_epi64(sums[2], sums[3])));
+    return static_cast<T>(static_cast<uint64_t>(sum_scalar(lanes, 4)) + static_cast<uint64_t>(sum_scalar(data + i, size - i)));
+}
+
+template <typename T>
+JG_REDUCE_TARGET("avx2") std::pair<T, T> min_max_avx2(const T* data, size_t size) noexcept
+{
+    __m256i min = _mm256_set1_epi64x(std::numeric_limits<int64_t>::max());
+    __m256i max = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+    size_t i = 0;
+
+    // There are no 64-bit integer min and max instructions before AVX-512, so compare and blend.
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        min = _mm256_blendv_epi8(min, values, _mm256_cmpgt_epi64(min, values));
+        max = _mm256_blendv_epi8(max, values, _mm256_cmpgt_epi64(values, max));
+    }
+
+    alignas(32) T mins[4];
+    alignas(32) T maxs[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(mins), min);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), max);
+
+    return min_max_scalar(data + i, size - i, {std::min({mins[0], mins[1], mins[2], mins[3]}), std::max({maxs[0], maxs[1], maxs[2], maxs[3]})});
+}
+
+// GCC 12 warns that the `_mm512_undefined_*()` operands inside the AVX-512 intrinsics are used
+// uninitialized (GCC bug 105593).
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+JG_REDUCE_TARGET("avx512f") inline double sum_avx512(const double* data, size_t size) noexcept
+{
+    __m512d sums[4] = {_mm512_setzero_pd(), _mm512_setzero_pd(), _mm512_setzero_pd(), _mm512_setzero_pd()};
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32)
+        for (size_t lane = 0; lane < 4; ++lane)
+            sums[lane] = _mm512_add_pd(sums[lane], _mm512_loadu_pd(data + i + lane * 8));
+
+    return _mm512_reduce_add_pd(_mm512_add_pd(_mm512_add_pd(sums[0], sums[1]), _mm512_add_pd(sums[2], sums[3]))) + sum_scalar(data + i, size - i);
+}
+
+// The same conversion as `to_double_avx2()`, since the conversion instruction needs AVX-512DQ.
+JG_REDUCE_TARGET("avx512f") inline __m512d to_double_avx512(__m512i values) noexcept
+{
+    const __m512i flipped = _mm512_xor_si512(values, _mm512_set1_epi64(std::numeric_limits<int64_t>::min()));
+    const __m512i high = _mm512_or_si512(_mm512_srli_epi64(flipped, 32), _mm512_castpd_si512(_mm512_set1_pd(0x1p84)));
+    const __m512i low = _mm512_mask_blend_epi32(0xaaaa, flipped, _mm512_castpd_si512(_mm512_set1_pd(0x1p52)));
+    return _mm512_add_pd(_mm512_sub_pd(_mm512_castsi512_pd(high), _mm512_set1_pd(0x1p84 + 0x1p63 + 0x1p52)), _mm512_castsi512_pd(low));
+}
+
+template <typename T>
+JG_REDUCE_TARGET("avx512f") __m512d load_double_avx512(const T* data) noexcept
+{
+    if constexpr (std::is_same_v<T, double>)
+        return _mm512_loadu_pd(data);
+    else
+        return to_double_avx512(_mm512_loadu_si512(data));
+}
+
+template <typename T>
+JG_REDUCE_TARGET("avx512f") square_sums square_sums_avx512(const T* data, size_t size, double offset) noexcept
+{
+    const __m512d offsets = _mm512_set1_pd(offset);
+    __m512d sums[2] = {_mm512_setzero_pd(), _mm512_setzero_pd()};
+    __m512d squares[2] = {_mm512_setzero_pd(), _mm512_setzero_pd()};
+    __m512d min = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+    __m512d max = _mm512_set1_pd(-std::numeric_limits<double>::infinity());
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16)
+    {
+        for (size_t lane = 0; lane < 2; ++lane)
+        {
+            const __m512d values = load_double_avx512(data + i + lane * 8);
+            const __m512d deviations = _mm512_sub_pd(values, offsets);
+            sums[lane] = _mm512_add_pd(sums[lane], deviations);
+            squares[lane] = _mm512_add_pd(squares[lane], _mm512_mul_pd(deviations, deviations));
+            min = _mm512_min_pd(min, values);
+            max = _mm512_max_pd(max, values);
+        }
+    }
+
+    square_sums result;
+    result.sum = _mm512_reduce_add_pd(_mm512_add_pd(sums[0], sums[1]));
+    result.sum_squares = _mm512_reduce_add_pd(_mm512_add_pd(squares[0], squares[1]));
+    result.min = _mm512_reduce_min_pd(min);
+    result.max = _mm512_reduce_max_pd(max);
+    combine(result, square_sums_scalar(data + i, size - i, offset));
+    return result;
+}
+
+template <typename T>
+JG_REDUCE_TARGET("avx512f") T sum_avx512(const T* data, size_t size) noexcept
+{
+    __m512i sums[4] = {_mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512()};
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32)
+        for (size_t lane = 0; lane < 4; ++lane)
+            sums[lane] = _mm512_add_epi64(sums[lane], _mm512_loadu_si512(data + i + lane * 8));
+
+    const auto sum = _mm512_reduce_add_epi64(_mm512_add_epi64(_mm512_add_epi64(sums[0], sums[1]), _mm512_add_epi64(sums[2], sums[3])));
+    return static_cast<T>(static_cast<uint64_t>(sum) + static_cast<uint64_t>(sum_scalar(data + i, size - i)));
+}
+
+template <typename T>
+JG_REDUCE_TARGET("avx512f") std::pair<T, T> min_max_avx512(const T* data, size_t size) noexcept
+{
+    __m512i min = _mm512_set1_epi64(std::numeric_limits<int64_t>::max());
+    __m512i max = _mm512_set1_epi64(std::numeric_limits<int64_t>::min());
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m512i values = _mm512_loadu_si512(data + i);
+        min = _mm512_min_epi64(min, values);
+        max = _mm512_max_epi64(max, values);
+    }
+
+    return min_max_scalar(data + i, size - i, {static_cast<T>(_mm512_reduce_min_epi64(min)), static_cast<T>(_mm512_reduce_max_epi64(max))});
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#elif defined(__aarch64__)
+
+inline double sum_neon(const double* data, size_t size) noexcept
+{
+    float64x2_t sums[4] = {vdupq_n_f64(0), vdupq_n_f64(0), vdupq_n_f64(0), vdupq_n_f64(0)};
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        for (size_t lane = 0; lane < 4; ++lane)
+            sums[lane] = vaddq_f64(sums[lane], vld1q_f64(data + i + lane * 2));
+
+    return vaddvq_f64(vaddq_f64(vaddq_f64(sums[0], sums[1]), vaddq_f64(sums[2], sums[3]))) + sum_scalar(data + i, size - i);
+}
+
+template <typename T>
+float64x2_t load_double_neon(const T* data) noexcept
+{
+    if constexpr (std::is_same_v<T, double>)
+        return vld1q_f64(data);
+    else
+        return vcvtq_f64_s64(vld1q_s64(reinterpret_cast<const int64_t*>(data)));
+}
+
+template <typename T>
+square_sums square_sums_neon(const T* data, size_t size, double offset) noexcept
+{
+    const float64x2_t offsets = vdupq_n_f64(offset);
+    float64x2_t sums[2] = {vdupq_n_f64(0), vdupq_n_f64(0)};
+    float64x2_t squares[2] = {vdupq_n_f64(0), vdupq_n_f64(0)};
+    float64x2_t min = vdupq_n_f64(std::numeric_limits<double>::infinity());
+    float64x2_t max = vdupq_n_f64(-std::numeric_limits<double>::infinity());
+    size_t i = 0;
+
+    for (; i + 4 <= size; i += 4)
+    {
+        for (size_t lane = 0; lane < 2; ++lane)
+        {
+            const float64x2_t values = load_double_neon(data + i + lane * 2);
+            const float64x2_t deviations = vsubq_f64(values, offsets);
+            sums[lane] = vaddq_f64(sums[lane], deviations);
+            squares[lane] = vaddq_f64(squares[lane], vmulq_f64(deviations, deviations));
+            min = vminq_f64(min, values);
+            max = vmaxq_f64(max, values);
+        }
+    }
+
+    square_sums result;
+    result.sum = vaddvq_f64(vaddq_f64(sums[0], sums[1]));
+    result.sum_squares = vaddvq_f64(vaddq_f64(squares[0], squares[1]));
+    result.min = vminvq_f64(min);
+    result.max = vmaxvq_f64(max);
+    combine(result, square_sums_scalar(data + i, size - i, offset));
+    return result;
+}
+
+template <typename T>
+T sum_neon(const T* data, size_t size) noexcept
+{
+    int64x2_t sums[4] = {vdupq_n_s64(0), vdupq_n_s64(0), vdupq_n_s64(0), vdupq_n_s64(0)};
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        for (size_t lane = 0; lane < 4; ++lane)
+            sums[lane] = vaddq_s64(sums[lane], vld1q_s64(reinterpret_cast<const int64_t*>(data + i + lane * 2)));
+
+    const auto sum = vaddvq_s64(vaddq_s64(vaddq_s64(sums[0], sums[1]), vaddq_s64(sums[2], sums[3])));
+    return static_cast<T>(static_cast<uint64_t>(sum) + static_cast<uint64_t>(sum_scalar(data + i, size - i)));
+}
+
+template <typename T>
+std::pair<T, T> min_max_neon(const T* data, size_t size) noexcept
+{
+    int64x2_t min = vdupq_n_s64(std::numeric_limits<int64_t>::max());
+    int64x2_t max = vdupq_n_s64(std::numeric_limits<int64_t>::min());
+    size_t i = 0;
+
+    for (; i + 2 <= size; i += 2)
+    {
+        const int64x2_t values = vld1q_s64(reinterpret_cast<const int64_t*>(data + i));
+        min = vbslq_s64(vcgtq_s64(min, values), values, min);
+        max = vbslq_s64(vcgtq_s64(values, max), values, max);
+    }
+
+    return min_max_scalar(data + i, size - i, {static_cast<T>(std::min(vgetq_lane_s64(min, 0), vgetq_lane_s64(min, 1))),
+                                               static_cast<T>(std::max(vgetq_lane_s64(max, 0), vgetq_lane_s64(max, 1)))});
+}
+
+#endif
+
+template <typename T>
+square_sums reduce_squares(jg::span<const T> values, double offset, simd_level level)
+{
+    jg::verify(is_supported(level));
+
+    switch (level)
+    {
+#if defined(JG_REDUCE_X86)
+        case simd_level::avx512: return square_sums_avx512(values.data(), values.size(), offset);
+        case simd_level::avx2:   return square_sums_avx2(values.data(), values.size(), offset);
+#elif defined(__aarch64__)
+        case simd_level::neon:   return square_sums_neon(values.data(), values.size(), offset);
+#endif
+        default:                 return square_sums_scalar(values.data(), values.size(), offset);
+    }
+}
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// The sum of `values`. Integer sums wrap around on overflow. `level` must be supported by the CPU,
+/// and is only given to compare the instruction sets.
+///
+/// @example
+///     const auto total = jg::sum(jg::span<const int64_t>{samples.data(), samples.size()});
+template <typename T>
+T sum(jg::span<const T> values, simd_level level = detected_simd_level())
+{
+    static_assert(is_simd_reducible_v<T>);
+    jg::verify(is_supported(level));
+
+    switch (level)
+    {
+#if defined(JG_REDUCE_X86)
+        case simd_level::avx512: return detail::sum_avx512(values.data(), values.size());
+        case simd_level::avx2:   return detail::sum_avx2(values.data(), values.size());
+#elif defined(__aarch64__)
+        case simd_level::neon:   return detail::sum_neon(values.data(), values.size());
+#endif
+        default:                 return detail::sum_scalar(values.data(), values.size());
+    }
+}
+
+/// The sum of `(value - offset)^2` of `values`. With the mean as `offset`, that is the variance times
+/// the number of values. 64-bit integers are converted to doubles in the vector lanes, so that their
+/// squares don't overflow.
+template <typename T>
+double sum_of_squares(jg::span<const T> values, double offset = 0, simd_level level = detected_simd_level())
+{
+    static_assert(is_simd_reducible_v<T>);
+    return detail::reduce_squares(values, offset, level).sum_squares;
+}
+
+/// The smallest and largest of the non-empty `values`.
+template <typename T>
+std::pair<T, T> min_max(jg::span<const T> values, simd_level level = detected_simd_level())
+{
+    static_assert(is_simd_reducible_v<T>);
+    jg::debug_verify(!values.empty());
+
+    if constexpr (std::is_same_v<T, double>)
+    {
+        const auto sums = detail::reduce_squares(values, 0, level);
+        return {sums.min, sums.max};
+    }
+    else
+    {
+        jg::verify(is_supported(level));
+
+        switch (level)
+        {
+#if defined(JG_REDUCE_X86)
+            case simd_level::avx512: return detail::min_max_avx512(values.data(), values.size());
+            case simd_level::avx2:   return detail::min_max_avx2(values.data(), values.size());
+#elif defined(__aarch64__)
+            case simd_level::neon:   return detail::min_max_neon(values.data(), values.size());
+#endif
+            default:                 return detail::min_max_scalar(values.data(), values.size(), {values[0], values[0]});
+        }
+    }
+}
+
+struct summary final
+{
+    size_t count{};
+    double mean{};
+    double variance{}; // The population variance.
+    double min{};
+    double max{};
+};
+
+/// The mean, variance, minimum and maximum of `values`, in one pass. The deviations are summed from
+/// the first value instead of from 0, so that the variance doesn't lose precision when it's small
+/// relative to the mean, as with timing samples. All 0 if empty.
+inline summary summarize(jg::span<const double> values, simd_level level = detected_simd_level())
+{
+    if (values.empty())
+        return {};
+
+    const double offset = values[0];
+    const auto sums = detail::reduce_squares(values, offset, level);
+    const auto count = static_cast<double>(values.size());
+    const double mean_deviation = sums.sum / count;
+
+    return {values.size(), offset + mean_deviation, std::max(0.0, sums.sum_squares / count - mean_deviation * mean_deviation), sums.min, sums.max};
+}
+
+} // namespace jg
+
+#undef JG_REDUCE_TARGET
+#undef JG_REDUCE_X86
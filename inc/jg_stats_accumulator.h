@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace jg::detail {
+
+/// A sum with Neumaier's improvement of Kahan's compensation: `compensation` collects the low-order
+/// bits that are lost when a small value is added to a large sum, so that `value()` stays accurate
+/// over billions of additions.
+struct compensated_sum final
+{
+    double sum{};
+    double compensation{};
+
+    void add(double value) noexcept
+    {
+        const double total = sum + value;
+
+        if (std::abs(sum) >= std::abs(value))
+            compensation += (sum - total) + value;
+        else
+            compensation += (value - total) + sum;
+
+        sum = total;
+    }
+
+    double value() const noexcept { return sum + compensation; }
+};
+
+} // namespace jg::detail
+
+namespace jg {
+
+/// One-pass mean, variance, skewness and kurtosis with Welford's method, extended to the third and
+/// fourth moments, in constant memory, for statistics over more values than are worth storing. Unlike
+/// summing powers, the updates don't lose precision when the variance is small relative to the mean,
+/// and the moments are compensated sums, so rounding errors don't accumulate over many values.
+/// Accumulators of different threads can be merged into one, for parallel reductions.
+///
+/// @example
+///     jg::stats_accumulator latencies;
+///     for (...)
+///         latencies.add(sw.ns());
+///     std::cout << latencies.mean() << " +- " << latencies.std_deviation() << " ns\n";
+///
+/// @example
+///     std::vector<jg::stats_accumulator> partial(thread_count);
+///     ... // thread i adds to partial[i]
+///     jg::stats_accumulator total;
+///     for (const auto& p : partial)
+///         total.merge(p);
+class stats_accumulator final
+{
+public:
+    void add(double value) noexcept
+    {
+        const double previous_count = static_cast<double>(m_count);
+        const double count = static_cast<double>(++m_count);
+        const double delta = value - m_mean.value();
+        const double delta_n = delta / count;
+        const double delta_n2 = delta_n * delta_n;
+        const double term = delta * delta_n * previous_count;
+        const double m2 = m_m2.value();
+        const double m3 = m_m3.value();
+
+        m_mean.add(delta_n);
+        m_m4.add(term * delta_n2 * (count * count - 3 * count + 3) + 6 * delta_n2 * m2 - 4 * delta_n * m3);
+        m_m3.add(term * delta_n * (count - 2) - 3 * delta_n * m2);
+        m_m2.add(delta * (value - m_mean.value())); // Equals `term`, but with less rounding.
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+
+    /// Adds the values of `other`, as if they had been added to this accumulator, with the pairwise
+    /// update of Chan et al. and Pébay.
+    void merge(const stats_accumulator& other) noexcept
+    {
+        if (other.empty())
+            return;
+
+        if (empty())
+        {
+            *this = other;
+            return;
+        }
+
+        const double count_a = static_cast<double>(m_count);
+        const double count_b = static_cast<double>(other.m_count);
+        const double count = count_a + count_b;
+        const double delta = other.mean() - mean();
+        const double delta2 = delta * delta;
+        const double m2_a = m_m2.value();
+        const double m2_b = other.m_m2.value();
+        const double m3_a = m_m3.value();
+        const double m3_b = other.m_m3.value();
+
+        const double m2 = m2_a + m2_b + delta2 * count_a * count_b / count;
+        const double m3 = m3_a + m3_b
+                        + delta * delta2 * count_a * count_b * (count_a - count_b) / (count * count)
+                        + 3 * delta * (count_a * m2_b - count_b * m2_a) / count;
+        const double m4 = m_m4.value() + other.m_m4.value()
+                        + delta2 * delta2 * count_a * count_b * (count_a * count_a - count_a * count_b + count_b * count_b) / (count * count * count)
+                        + 6 * delta2 * (count_a * count_a * m2_b + count_b * count_b * m2_a) / (count * count)
+                        + 4 * delta * (count_a * m3_b - count_b * m3_a) / count;
+
+        m_mean = {mean() + delta * count_b / count, 0};
+        m_m2 = {m2, 0};
+        m_m3 = {m3, 0};
+        m_m4 = {m4, 0};
+        m_count += other.m_count;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    uint64_t count() const noexcept { return m_count; }
+    bool empty() const noexcept { return m_count == 0; }
+
+    /// 0 if empty.
+    double mean() const noexcept { return m_mean.value(); }
+
+    /// The population variance. 0 if empty.
+    double variance() const noexcept { return empty() ? 0.0 : std::max(0.0, m_m2.value()) / static_cast<double>(m_count); }
+
+    /// The population standard deviation. 0 if empty.
+    double std_deviation() const noexcept { return std::sqrt(variance()); }
+
+    /// The population skewness: 0 for symmetric values, positive if the values have a longer tail
+    /// above the mean, like timing samples. 0 if the variance is 0.
+    double skewness() const noexcept
+    {
+        const double m2 = m_m2.value();
+        return m2 > 0 ? std::sqrt(static_cast<double>(m_count)) * m_m3.value() / std::pow(m2, 1.5) : 0.0;
+    }
+
+    /// The population excess kurtosis: 0 for normally distributed values, and positive if the values
+    /// have more outliers than that. 0 if the variance is 0.
+    double kurtosis() const noexcept
+    {
+        const double m2 = m_m2.value();
+        return m2 > 0 ? static_cast<double>(m_count) * m_m4.value() / (m2 * m2) - 3 : 0.0;
+    }
+
+    /// 0 if empty.
+    double min() const noexcept { return empty() ? 0.0 : m_min; }
+
+    /// 0 if empty.
+    double max() const noexcept { return empty() ? 0.0 : m_max; }
+
+private:
+    uint64_t m_count{};
+    detail::compensated_sum m_mean;
+    detail::compensated_sum m_m2; // The sums of the 2nd, 3rd and 4th powers of the deviations from the mean.
+    detail::compensated_sum m_m3;
+    detail::compensated_sum m_m4;
+    double m_min{std::numeric_limits<double>::infinity()};
+    double m_max{-std::numeric_limits<double>::infinity()};
+};
+
+} // namespace jg
@@ -1,33 +1,107 @@
 #pragma once
 
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include "jg_cycle_clock.h"
 
 namespace jg {
 
-/// The simplest possible .Net StopWatch rip-off. Continues to measure time from instantiation, regardless
-/// of how many times `ms()`, `us()` or `ns()` are called. Only restarts when assigned a new instance.
+/// Ticks of `std::chrono::steady_clock`, which never jumps, unlike `system_clock` (which
+/// `high_resolution_clock` is on libstdc++) when NTP or the user adjusts the time.
+struct steady_ticks final
+{
+    static int64_t now() noexcept
+    {
+        return static_cast<int64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    static double ns_per_tick() noexcept
+    {
+        using period = std::chrono::steady_clock::period;
+        return 1e9 * static_cast<double>(period::num) / static_cast<double>(period::den);
+    }
+};
+
+/// Ticks of `jg::cycle_clock`, which are cheaper to read than `steady_clock` and have a finer
+/// resolution, at the cost of a calibration of about 20 ms on the first conversion to time.
+struct cycle_ticks final
+{
+    static int64_t now() noexcept { return static_cast<int64_t>(jg::cycle_clock::start()); }
+    static double ns_per_tick() noexcept { return jg::cycle_clock_ns_per_cycle(); }
+};
+
+/// The simplest possible .Net StopWatch rip-off. Starts measuring time at instantiation, and keeps
+/// measuring regardless of how many times `ms()`, `us()` or `ns()` are called. `pause()` and `resume()`
+/// exclude time from the measurement, `lap()` measures from the previous lap, and `restart()` (or
+/// assigning a new instance) starts over. `Ticks` is `steady_ticks` or `cycle_ticks`, or any type
+/// with the same static functions. The state is three 64-bit integers, so instances are cheap to keep
+/// around in numbers.
 ///
 /// @example
 ///     stopwatch sw; // starts timing
 ///     op1();
 ///     std::cout << "op1() took " << sw.ns() << " ns\n";
-///     sw = {}; // "restarts" timing
+///     sw.restart();
 ///     op2();
-///     std::cout << "op2() took " << sw.ms() << " ms\n";
-class stopwatch final
+///     sw.pause();
+///     not_measured();
+///     sw.resume();
+///     op3();
+///     std::cout << "op2() and op3() took " << sw.ms() << " ms\n";
+template <typename Ticks>
+class basic_stopwatch final
 {
 public:
-    std::chrono::milliseconds::rep ms() const { return rep<std::chrono::milliseconds>(); }
-    std::chrono::microseconds::rep us() const { return rep<std::chrono::microseconds>(); }
-    std::chrono::nanoseconds::rep  ns() const { return rep<std::chrono::nanoseconds>(); }
+    std::chrono::milliseconds::rep ms() const noexcept { return ns() / 1'000'000; }
+    std::chrono::microseconds::rep us() const noexcept { return ns() / 1'000; }
+    std::chrono::nanoseconds::rep  ns() const noexcept { return to_ns(ticks()); }
+
+    /// The measured ticks, excluding the paused time.
+    int64_t ticks() const noexcept { return m_start == paused ? m_accumulated : m_accumulated + Ticks::now() - m_start; }
+
+    bool is_running() const noexcept { return m_start != paused; }
+
+    /// Stops measuring, until `resume()`. Does nothing if already paused.
+    void pause() noexcept
+    {
+        if (m_start != paused)
+            m_accumulated += Ticks::now() - std::exchange(m_start, paused);
+    }
+
+    /// Continues measuring after `pause()`. Does nothing if not paused.
+    void resume() noexcept
+    {
+        if (m_start == paused)
+            m_start = Ticks::now();
+    }
+
+    /// Starts over from 0, running.
+    void restart() noexcept { *this = {}; }
+
+    /// The nanoseconds measured since the previous `lap()`, or since the start for the first lap.
+    std::chrono::nanoseconds::rep lap() noexcept
+    {
+        const auto now = ticks();
+        return to_ns(now - std::exchange(m_lap, now));
+    }
 
 private:
-    using clock = std::chrono::high_resolution_clock;
+    static constexpr int64_t paused = std::numeric_limits<int64_t>::min();
+
+    static std::chrono::nanoseconds::rep to_ns(int64_t ticks) noexcept
+    {
+        return static_cast<std::chrono::nanoseconds::rep>(std::llround(static_cast<double>(ticks) * Ticks::ns_per_tick()));
+    }
 
-    template <typename T>
-    typename T::rep rep() const { return std::chrono::duration_cast<T>(clock::now() - m_start).count(); }
-    
-    clock::time_point m_start{clock::now()};
+    int64_t m_start{Ticks::now()};
+    int64_t m_accumulated{};
+    int64_t m_lap{};
 };
 
+using stopwatch = basic_stopwatch<steady_ticks>;
+using cycle_stopwatch = basic_stopwatch<cycle_ticks>;
+
 } // namespace jg
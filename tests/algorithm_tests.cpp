@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <jg_algorithm.h>
+#include <jg_test.h>
+
+namespace {
+
+std::vector<double> make_measurements(const std::vector<double>& sizes, double (*g)(double))
+{
+    std::vector<double> measurements;
+    for (double n : sizes)
+        measurements.push_back(3.0 * g(n) + 10.0);
+    return measurements;
+}
+
+jg::test_adder algorithm_tests { "algorithm", {
+    jg::test_suite { "median with scratch", {
+        jg::test_case { "odd and even sizes => same as the reordering median, input unchanged", [] {
+            for (size_t size = 1; size <= 20; ++size)
+            {
+                std::vector<int> values(size);
+                for (size_t i = 0; i < size; ++i)
+                    values[i] = static_cast<int>((i * 7919) % 23);
+
+                const auto original = values;
+                std::vector<int> scratch(size);
+                const auto median = jg::median(values.begin(), values.end(), jg::span<int>{scratch.data(), scratch.size()});
+                jg_test_assert(values == original);
+
+                auto reordered = values;
+                jg_test_assert(median == jg::median(reordered.begin(), reordered.end()));
+            }
+        }},
+        jg::test_case { "all permutations up to the sorting network size => sorted", [] {
+            for (size_t size = 1; size <= jg::detail::sorting_network_max_size; ++size)
+            {
+                std::vector<int> permutation(size);
+                std::iota(permutation.begin(), permutation.end(), 0);
+                bool all_sorted = true;
+
+                do
+                {
+                    auto values = permutation;
+                    jg::detail::sort_small(values.data(), values.size());
+                    all_sorted = all_sorted && std::is_sorted(values.begin(), values.end());
+                }
+                while (std::next_permutation(permutation.begin(), permutation.end()));
+
+                jg_test_assert(all_sorted);
+            }
+        }}
+    }},
+    jg::test_suite { "standard_deviation", {
+        jg::test_case { "large integers => no overflow", [] {
+            const std::vector<long long> values{0, 8'000'000'000};
+            jg_test_assert(jg::standard_deviation(values.begin(), values.end(), 4'000'000'000LL) == 4'000'000'000);
+        }},
+        jg::test_case { "integers => rounded, not truncated", [] {
+            const std::vector<long long> values{0, 1, 1, 1};
+            jg_test_assert(jg::standard_deviation(values.begin(), values.end(), 0LL) == 1);
+            jg_test_assert(std::abs(jg::standard_deviation<std::vector<long long>::const_iterator, long long, double>(values.begin(), values.end(), 0LL) - std::sqrt(0.75)) < 1e-12);
+        }}
+    }},
+    jg::test_suite { "median_and_deviation", {
+        jg::test_case { "values => median and MAD, input unchanged", [] {
+            const std::vector<long long> values{9, 1, 2, 6, 4, 2, 1, 5, 3, 100};
+            std::vector<long long> scratch(values.size());
+            const jg::span<long long> span{scratch.data(), scratch.size()};
+            const auto result = jg::median_and_deviation(values.begin(), values.end(), span);
+            jg_test_assert(result.median == 4);
+            jg_test_assert(result.median_abs_deviation == 2);
+            jg_test_assert(result.median_abs_deviation == jg::median_absolute_deviation(values.begin(), values.end(), 4LL));
+            jg_test_assert(result.median_abs_deviation == jg::median_absolute_deviation(values.begin(), values.end(), 4LL, span));
+            jg_test_assert((values == std::vector<long long>{9, 1, 2, 6, 4, 2, 1, 5, 3, 100}));
+        }},
+        jg::test_case { "unsigned values => no wrap around", [] {
+            const std::vector<unsigned> values{10, 1, 7};
+            std::vector<unsigned> scratch(values.size());
+            const auto result = jg::median_and_deviation(values.begin(), values.end(), jg::span<unsigned>{scratch.data(), scratch.size()});
+            jg_test_assert(result.median == 7);
+            jg_test_assert(result.median_abs_deviation == 3);
+        }}
+    }},
+    jg::test_suite { "fit_complexity", {
+        jg::test_case { "constant measurements => O(1)", [] {
+            const std::vector<double> sizes{1, 8, 64, 512, 4096};
+            const std::vector<double> times{5, 5, 5, 5, 5};
+            const auto fit = jg::fit_complexity(sizes.begin(), sizes.end(), times.begin());
+            jg_test_assert(fit.complexity == jg::complexity::o_1);
+            jg_test_assert(fit.coefficient == 5);
+            jg_test_assert(fit.rms == 0);
+        }},
+        jg::test_case { "linear measurements => O(n)", [] {
+            const std::vector<double> sizes{1, 8, 64, 512, 4096, 32768};
+            const auto times = make_measurements(sizes, [] (double n) { return n; });
+            const auto fit = jg::fit_complexity(sizes.begin(), sizes.end(), times.begin());
+            jg_test_assert(fit.complexity == jg::complexity::o_n);
+        }},
+        jg::test_case { "n log n measurements => O(n log n)", [] {
+            const std::vector<double> sizes{1, 8, 64, 512, 4096, 32768};
+            const auto times = make_measurements(sizes, [] (double n) { return n * std::log2(n); });
+            const auto fit = jg::fit_complexity(sizes.begin(), sizes.end(), times.begin());
+            jg_test_assert(fit.complexity == jg::complexity::o_n_log_n);
+        }},
+        jg::test_case { "quadratic measurements => O(n^2)", [] {
+            const std::vector<double> sizes{1, 8, 64, 512, 4096, 32768};
+            const auto times = make_measurements(sizes, [] (double n) { return n * n; });
+            const auto fit = jg::fit_complexity(sizes.begin(), sizes.end(), times.begin());
+            jg_test_assert(fit.complexity == jg::complexity::o_n_squared);
+            jg_test_assert(jg::to_string(fit.complexity) == "O(n^2)");
+        }}
+    }},
+    jg::test_suite { "mann_whitney_u", {
+        jg::test_case { "identical ranges => not significant", [] {
+            const std::vector<int> values{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+            const auto result = jg::mann_whitney_u(values.begin(), values.end(), values.begin(), values.end());
+            jg_test_assert(result.u == 50);
+            jg_test_assert(result.p_value == 1);
+        }},
+        jg::test_case { "separated ranges => significant with expected sign", [] {
+            const std::vector<int> low{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+            const std::vector<int> high{11, 12, 13, 14, 15, 16, 17, 18, 19, 20};
+            const auto result = jg::mann_whitney_u(high.begin(), high.end(), low.begin(), low.end());
+            jg_test_assert(result.u == 100);
+            jg_test_assert(result.z > 0);
+            jg_test_assert(result.p_value < 0.001);
+        }},
+        jg::test_case { "all values tied => not significant", [] {
+            const std::vector<int> values(10, 7);
+            jg_test_assert(jg::mann_whitney_u(values.begin(), values.end(), values.begin(), values.end()).p_value == 1);
+        }},
+        jg::test_case { "empty range => not significant", [] {
+            const std::vector<int> values{1, 2, 3};
+            jg_test_assert(jg::mann_whitney_u(values.begin(), values.end(), values.end(), values.end()).p_value == 1);
+        }}
+    }},
+    jg::test_suite { "bootstrap_median_interval", {
+        jg::test_case { "equal values => zero width interval", [] {
+            const std::vector<int> values(20, 7);
+            const auto interval = jg::bootstrap_median_interval(values.begin(), values.end());
+            jg_test_assert(interval.low == 7 && interval.high == 7);
+        }},
+        jg::test_case { "1..100 => interval around the median", [] {
+            std::vector<double> values(100);
+            std::iota(values.begin(), values.end(), 1.0);
+            const auto interval = jg::bootstrap_median_interval(values.begin(), values.end(), 0.9);
+            jg_test_assert(interval.low < 51 && interval.high > 51);
+            jg_test_assert(interval.low > 35 && interval.high < 65);
+            const auto wider = jg::bootstrap_median_interval(values.begin(), values.end(), 0.99);
+            jg_test_assert(wider.low <= interval.low && wider.high >= interval.high);
+        }},
+        jg::test_case { "empty => empty interval", [] {
+            const std::vector<double> values;
+            const auto interval = jg::bootstrap_median_interval(values.begin(), values.end());
+            jg_test_assert(interval.low == 0 && interval.high == 0);
+        }}
+    }}
+}};
+
+}
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <jg_benchmark_environment.h>
+#include <jg_test.h>
+
+namespace {
+
+bool has_warning(const std::vector<std::string>& warnings, std::string_view text)
+{
+    return std::any_of(warnings.begin(), warnings.end(), [text] (const auto& warning) { return warning.find(text) != std::string::npos; });
+}
+
+jg::test_adder benchmark_environment_tests { "benchmark_environment", {
+    jg::test_suite { "capture_benchmark_environment", {
+        jg::test_case { "this process => cpu count and compiler", [] {
+            const auto environment = jg::capture_benchmark_environment();
+            jg_test_assert(environment.cpu_count > 0);
+            jg_test_assert(!environment.compiler.empty());
+            jg_test_assert(!environment.pinned_cpu);
+        }}
+    }},
+    jg::test_suite { "benchmark_environment_warnings", {
+        jg::test_case { "quiet environment => no warnings", [] {
+            jg::benchmark_environment environment;
+            environment.governor = "performance";
+            environment.turbo = false;
+            environment.load_average = 0.1;
+            environment.build_flags = "optimized NDEBUG";
+            jg_test_assert(jg::benchmark_environment_warnings(environment).empty());
+        }},
+        jg::test_case { "noisy environment => warnings", [] {
+            jg::benchmark_environment environment;
+            environment.governor = "powersave";
+            environment.turbo = true;
+            environment.load_average = 3.5;
+            const auto warnings = jg::benchmark_environment_warnings(environment);
+            jg_test_assert(warnings.size() == 4);
+            jg_test_assert(has_warning(warnings, "powersave"));
+            jg_test_assert(has_warning(warnings, "Turbo"));
+            jg_test_assert(has_warning(warnings, "load average"));
+            jg_test_assert(has_warning(warnings, "optimized"));
+            jg_test_assert(has_warning(warnings, "The load average is 3.50 on 1 CPU."));
+        }},
+        jg::test_case { "load average below the cpu count => no load warning", [] {
+            jg::benchmark_environment environment;
+            environment.cpu_count = 4;
+            environment.load_average = 3.5;
+            jg_test_assert(!has_warning(jg::benchmark_environment_warnings(environment), "load average"));
+            environment.load_average = 4.25;
+            jg_test_assert(has_warning(jg::benchmark_environment_warnings(environment), "The load average is 4.25 on 4 CPUs."));
+        }}
+    }},
+    jg::test_suite { "benchmark_environment_differences", {
+        jg::test_case { "other cpu and compiler => differences", [] {
+            jg::benchmark_environment baseline;
+            baseline.cpu_model = "a";
+            baseline.compiler = "gcc";
+            baseline.load_average = 2;
+            auto current = baseline;
+            jg_test_assert(jg::benchmark_environment_differences(baseline, current).empty());
+            current.cpu_model = "b";
+            current.compiler = "clang";
+            current.load_average = 0;
+            jg_test_assert(jg::benchmark_environment_differences(baseline, current).size() == 2);
+        }}
+    }}
+}};
+
+}
@@ -0,0 +1,103 @@
+#include <sstream>
+#include <jg_benchmark_history.h>
+#include <jg_test.h>
+
+namespace {
+
+jg::benchmark_history_record make_record(int64_t time, std::string commit, std::string description, int64_t median)
+{
+    return {time, std::move(commit), "0123456789abcdef", std::move(description), median, median / 10, median * 2};
+}
+
+jg::test_adder benchmark_history_tests { "benchmark_history", {
+    jg::test_suite { "benchmark_environment_hash", {
+        jg::test_case { "same comparable fields => same hash", [] {
+            jg::benchmark_environment environment;
+            environment.cpu_model = "cpu";
+            environment.cpu_count = 8;
+            auto other = environment;
+            other.load_average = 3.0;
+            other.pinned_cpu = 2;
+            jg_test_assert(jg::benchmark_environment_hash(environment).size() == 16);
+            jg_test_assert(jg::benchmark_environment_hash(environment) == jg::benchmark_environment_hash(other));
+        }},
+        jg::test_case { "different comparable fields => different hash", [] {
+            jg::benchmark_environment environment;
+            auto other = environment;
+            other.compiler = "gcc";
+            jg_test_assert(jg::benchmark_environment_hash(environment) != jg::benchmark_environment_hash(other));
+        }}
+    }},
+    jg::test_suite { "read_benchmark_history", {
+        jg::test_case { "write_benchmark_history => read back", [] {
+            jg::benchmark_result result;
+            result.description = "a \"quoted\", case";
+            result.median = 100;
+            result.median_abs_deviation = 5;
+            result.p99 = 180;
+            const auto records = jg::benchmark_history_records({result}, "abc123", {}, 1700000000);
+
+            std::stringstream stream;
+            stream << "# header\n";
+            jg::write_benchmark_history(stream, records);
+            jg::write_benchmark_history(stream, records);
+            const auto read = jg::read_benchmark_history(stream);
+            jg_test_assert(read && read->size() == 2);
+            jg_test_assert((*read)[1].time == 1700000000);
+            jg_test_assert((*read)[1].commit == "abc123");
+            jg_test_assert((*read)[1].environment == jg::benchmark_environment_hash({}));
+            jg_test_assert((*read)[1].description == result.description);
+            jg_test_assert((*read)[1].median == 100);
+            jg_test_assert((*read)[1].median_abs_deviation == 5);
+            jg_test_assert((*read)[1].p99 == 180);
+        }},
+        jg::test_case { "malformed => nullopt", [] {
+            std::istringstream stream{"1700000000,\"abc\",hash,\"case\",x,1,2\n"};
+            jg_test_assert(!jg::read_benchmark_history(stream));
+        }}
+    }},
+    jg::test_suite { "change_points", {
+        jg::test_case { "too few values => none", [] {
+            jg_test_assert(jg::change_points({100, 100, 200, 200, 200}).empty());
+        }},
+        jg::test_case { "noise => none", [] {
+            jg_test_assert(jg::change_points({100, 102, 99, 101, 98, 100, 103, 99, 101, 100}).empty());
+        }},
+        jg::test_case { "slow drift => none", [] {
+            jg_test_assert(jg::change_points({100, 101, 102, 103, 104, 105, 106, 107, 108, 109}).empty());
+        }},
+        jg::test_case { "steps => their indexes", [] {
+            const auto points = jg::change_points({100, 102, 99, 101, 130, 131, 129, 130, 132, 110, 109, 111, 110});
+            jg_test_assert(points == std::vector<size_t>({4, 9}));
+        }},
+        jg::test_case { "step below threshold => none", [] {
+            jg_test_assert(jg::change_points({100, 100, 100, 100, 103, 103, 103, 103}).empty());
+            jg_test_assert(jg::change_points({100, 100, 100, 100, 103, 103, 103, 103}, 0.01) == std::vector<size_t>({4}));
+        }}
+    }},
+    jg::test_suite { "benchmark_trends", {
+        jg::test_case { "records => grouped, ordered by time, with steps", [] {
+            std::vector<jg::benchmark_history_record> records;
+
+            for (int64_t i = 0; i < 8; ++i)
+            {
+                records.push_back(make_record(i, "c" + std::to_string(i), "a", i < 4 ? 100 : 200));
+                records.push_back(make_record(7 - i, "c" + std::to_string(7 - i), "b", 50));
+            }
+
+            const auto trends = jg::benchmark_trends(records);
+            jg_test_assert(trends.size() == 2);
+            jg_test_assert(trends[0].description == "a" && trends[0].runs.size() == 8);
+            jg_test_assert(trends[0].change_points == std::vector<size_t>({4}));
+            jg_test_assert(trends[1].description == "b" && trends[1].runs.front().time == 0);
+            jg_test_assert(trends[1].change_points.empty());
+
+            std::ostringstream stream;
+            jg::write_trends(stream, trends);
+            jg_test_assert(stream.str().find("step         c3 -> c4") != std::string::npos);
+            jg_test_assert(stream.str().find("+100.0%") != std::string::npos);
+        }}
+    }}
+}};
+
+} // namespace
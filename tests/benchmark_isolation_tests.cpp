@@ -0,0 +1,93 @@
+#include <cstdlib>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+#include <jg_benchmark_isolation.h>
+#include <jg_test.h>
+
+namespace {
+
+int g_parent_state = 0;
+
+jg::test_adder benchmark_isolation_tests { "benchmark_isolation", {
+    jg::test_suite { "current_process_stats", {
+        jg::test_case { "this process => some usage", [] {
+            const auto stats = jg::current_process_stats();
+            jg_test_assert(!stats || stats->max_rss_bytes > 0);
+        }}
+    }},
+    jg::test_suite { "benchmark_isolated", {
+        jg::test_case { "results => read back with process stats", [] {
+            const auto results = jg::benchmark_isolated([] {
+                return std::vector{jg::benchmark("a", {5, 1}, [] {}), jg::benchmark("b", {3, 1}, [] {})};
+            });
+            jg_test_assert(results && results->size() == 2);
+            jg_test_assert((*results)[0].description == "a" && (*results)[0].samples.size() == 5);
+            jg_test_assert((*results)[1].description == "b" && (*results)[1].samples.size() == 3);
+#if defined(__unix__) || defined(__APPLE__)
+            jg_test_assert((*results)[0].process && (*results)[0].process->max_rss_bytes > 0);
+#endif
+        }},
+        jg::test_case { "touching memory => page faults", [] {
+            const auto results = jg::benchmark_isolated([] {
+                return std::vector{jg::benchmark("touch", {1, 1}, [] {
+                    std::vector<char> memory(size_t{16} << 20);
+                    for (size_t i = 0; i < memory.size(); i += 4096)
+                        memory[i] = 1;
+                })};
+            });
+            jg_test_assert(results && results->size() == 1);
+#if defined(__unix__) || defined(__APPLE__)
+            jg_test_assert(results->front().process->minor_page_faults > 1000);
+#endif
+        }},
+#if defined(__unix__) || defined(__APPLE__)
+        jg::test_case { "child state => not in parent", [] {
+            const auto results = jg::benchmark_isolated([] {
+                g_parent_state = 1;
+                return std::vector<jg::benchmark_result>{};
+            });
+            jg_test_assert(results && results->empty());
+            jg_test_assert(g_parent_state == 0);
+        }},
+        jg::test_case { "failing child => nullopt", [] {
+            const auto results = jg::benchmark_isolated([] () -> std::vector<jg::benchmark_result> {
+                _exit(3);
+            });
+            jg_test_assert(!results);
+        }},
+        jg::test_case { "throwing child => nullopt, and the exception doesn't escape the child", [] {
+            // The child reports an escaped exception on this pipe, since the parent can't see it otherwise.
+            int escaped[2];
+            jg_test_assert(pipe(escaped) == 0);
+            const auto parent = getpid();
+            std::optional<std::vector<jg::benchmark_result>> results;
+
+            try
+            {
+                results = jg::benchmark_isolated([] () -> std::vector<jg::benchmark_result> {
+                    throw std::runtime_error{"failed"};
+                });
+            }
+            catch (...)
+            {
+                if (getpid() != parent)
+                {
+                    [[maybe_unused]] const auto written = write(escaped[1], "x", 1);
+                    _exit(0);
+                }
+
+                throw;
+            }
+
+            close(escaped[1]);
+            char buffer;
+            jg_test_assert(read(escaped[0], &buffer, 1) == 0);
+            close(escaped[0]);
+            jg_test_assert(!results);
+        }}
+#endif
+    }}
+}};
+
+} // namespace
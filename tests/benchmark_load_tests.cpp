@@ -0,0 +1,38 @@
+#include <jg_benchmark_load.h>
+#include <jg_test.h>
+
+namespace {
+
+jg::test_adder benchmark_load_tests { "benchmark_load", {
+    jg::test_suite { "benchmark_load", {
+        jg::test_case { "fast operations => achieved rate ~ target rate", [] {
+            size_t calls = 0;
+            const auto load = jg::benchmark_load("op", {1000, std::chrono::milliseconds{100}}, [&] { ++calls; });
+            jg_test_assert(load.latency.description == "op/latency");
+            jg_test_assert(load.service_time.description == "op/service_time");
+            jg_test_assert(calls == 100);
+            jg_test_assert(load.target_rate == 1000);
+            jg_test_assert(load.achieved_rate > 900 && load.achieved_rate < 1100);
+            jg_test_assert(load.latency.samples.empty());
+        }},
+        jg::test_case { "stalled operation => later latencies include the wait", [] {
+            // Every 20th operation takes 5 intervals, so the 4 operations scheduled after it start late.
+            const auto load = jg::benchmark_load("op", {1000, std::chrono::milliseconds{200}, {}, true}, [] (size_t operation) {
+                if (operation % 20 == 0)
+                    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            });
+            jg_test_assert(load.latency.samples.size() == 200);
+            jg_test_assert(load.latency.p90 >= 1'000'000);
+            jg_test_assert(load.service_time.p90 < 1'000'000);
+            jg_test_assert(load.latency.median <= load.latency.p90);
+        }},
+        jg::test_case { "warmup => not measured", [] {
+            size_t calls = 0;
+            const auto load = jg::benchmark_load("op", {1000, std::chrono::milliseconds{20}, std::chrono::milliseconds{10}, true}, [&] { ++calls; });
+            jg_test_assert(calls == 30);
+            jg_test_assert(load.latency.samples.size() == 20);
+        }}
+    }}
+}};
+
+} // namespace
@@ -0,0 +1,200 @@
+#include <sstream>
+#include <jg_benchmark_report.h>
+#include <jg_test.h>
+
+namespace {
+
+std::vector<jg::benchmark_result> make_results()
+{
+    jg::benchmark_result plain;
+    plain.description = "plain";
+    plain.samples = {1, 2, 3};
+    plain.average = 2;
+    plain.median = 2;
+    plain.std_deviation = 1;
+    plain.median_abs_deviation = 1;
+
+    jg::benchmark_result quoted = plain;
+    quoted.description = "needs \"quoting\", in csv and json\\ \xce\xbcs\t";
+    quoted.samples = {9223372036854775807};
+    quoted.perf_counters = jg::perf_counter_stats{};
+    quoted.perf_counters->instructions_per_cycle = 1.5;
+    quoted.perf_counters->multiplexed = true;
+    quoted.allocations = jg::allocation_stats{2.5, 96, 128};
+    quoted.bytes_per_second = 1.25e9;
+    quoted.cycles = jg::cycle_stats{12.5, 13.25, 0.3125, 24};
+    quoted.process = jg::process_stats{1 << 26, 17000, 3};
+
+    return {plain, quoted};
+}
+
+bool round_trips(const std::vector<jg::benchmark_result>& written, const std::vector<jg::benchmark_result>& read)
+{
+    if (written.size() != read.size())
+        return false;
+
+    for (size_t i = 0; i < written.size(); ++i)
+    {
+        if (written[i].description != read[i].description ||
+            written[i].samples != read[i].samples ||
+            written[i].median != read[i].median ||
+            written[i].perf_counters.has_value() != read[i].perf_counters.has_value() ||
+            written[i].allocations.has_value() != read[i].allocations.has_value() ||
+            written[i].items_per_second != read[i].items_per_second ||
+            written[i].bytes_per_second != read[i].bytes_per_second ||
+            written[i].cycles.has_value() != read[i].cycles.has_value() ||
+            written[i].process.has_value() != read[i].process.has_value())
+            return false;
+
+        if (written[i].allocations && (written[i].allocations->allocations != read[i].allocations->allocations ||
+                                       written[i].allocations->peak_live_bytes != read[i].allocations->peak_live_bytes))
+            return false;
+
+        if (written[i].cycles && (written[i].cycles->median != read[i].cycles->median ||
+                                  written[i].cycles->ns_per_cycle != read[i].cycles->ns_per_cycle))
+            return false;
+
+        if (written[i].process && (written[i].process->max_rss_bytes != read[i].process->max_rss_bytes ||
+                                   written[i].process->minor_page_faults != read[i].process->minor_page_faults ||
+                                   written[i].process->major_page_faults != read[i].process->major_page_faults))
+            return false;
+
+        if (written[i].perf_counters && (written[i].perf_counters->instructions_per_cycle != read[i].perf_counters->instructions_per_cycle ||
+                                         written[i].perf_counters->multiplexed != read[i].perf_counters->multiplexed))
+            return false;
+    }
+
+    return true;
+}
+
+jg::benchmark_environment make_environment()
+{
+    jg::benchmark_environment environment;
+    environment.cpu_model = "Flubber \"Quoted\" CPU @ 3.00GHz";
+    environment.cpu_count = 8;
+    environment.turbo = false;
+    environment.load_average = 0.25;
+    environment.build_flags = "optimized NDEBUG";
+    return environment;
+}
+
+std::vector<jg::benchmark_result> make_baseline(jg::benchmark_result::sample_type first_sample)
+{
+    jg::benchmark_result result;
+    result.description = "b";
+
+    for (jg::benchmark_result::sample_type i = 0; i < 20; ++i)
+        result.samples.push_back(first_sample + i);
+
+    result.median = first_sample + 10;
+    return {result};
+}
+
+jg::test_adder benchmark_report_tests { "benchmark_report", {
+    jg::test_suite { "read_benchmark_results", {
+        jg::test_case { "write_json => read back", [] {
+            const auto results = make_results();
+            std::stringstream stream;
+            jg::write_json(stream, results);
+            const auto read = jg::read_benchmark_results(stream);
+            jg_test_assert(read.has_value());
+            jg_test_assert(round_trips(results, *read));
+        }},
+        jg::test_case { "write_csv => read back", [] {
+            const auto results = make_results();
+            std::stringstream stream;
+            jg::write_csv(stream, results);
+            const auto read = jg::read_benchmark_results(stream);
+            jg_test_assert(read.has_value());
+            jg_test_assert(round_trips(results, *read));
+        }},
+        jg::test_case { "empty or malformed => nullopt", [] {
+            std::stringstream empty;
+            jg_test_assert(!jg::read_benchmark_results(empty));
+            std::stringstream truncated{"{\"benchmarks\": [{\"description\": \"x\""};
+            jg_test_assert(!jg::read_benchmark_results(truncated));
+            std::stringstream no_header{"a,b,c\n1,2,3\n"};
+            jg_test_assert(!jg::read_benchmark_results(no_header));
+        }},
+        jg::test_case { "escaped code points => UTF-8", [] {
+            std::stringstream stream{R"({"benchmarks": [{"description": "\u0041\u00e9\u20AC\ud83d\ude00\ud83d-"}]})"};
+            const auto read = jg::read_benchmark_results(stream);
+            jg_test_assert(read.has_value());
+            jg_test_assert(read->size() == 1);
+            jg_test_assert((*read)[0].description == "A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\xef\xbf\xbd-");
+        }}
+    }},
+    jg::test_suite { "read_benchmark_environment", {
+        jg::test_case { "write_json with environment => read back", [] {
+            std::stringstream stream;
+            jg::write_json(stream, make_results(), make_environment());
+            const std::string document = stream.str();
+            std::istringstream results_stream{document};
+            std::istringstream environment_stream{document};
+            jg_test_assert(round_trips(make_results(), jg::read_benchmark_results(results_stream).value()));
+            const auto environment = jg::read_benchmark_environment(environment_stream);
+            jg_test_assert(environment && environment->cpu_model == make_environment().cpu_model);
+            jg_test_assert(environment->cpu_count == 8 && environment->turbo == false && environment->load_average == 0.25);
+            jg_test_assert(!environment->pinned_cpu);
+            jg_test_assert(jg::benchmark_environment_differences(make_environment(), *environment).empty());
+        }},
+        jg::test_case { "write_csv with environment => read back", [] {
+            std::stringstream stream;
+            jg::write_csv(stream, make_results(), make_environment());
+            const std::string document = stream.str();
+            std::istringstream results_stream{document};
+            std::istringstream environment_stream{document};
+            jg_test_assert(round_trips(make_results(), jg::read_benchmark_results(results_stream).value()));
+            const auto environment = jg::read_benchmark_environment(environment_stream);
+            jg_test_assert(environment && environment->build_flags == "optimized NDEBUG");
+            jg_test_assert(jg::benchmark_environment_differences(make_environment(), *environment).empty());
+        }},
+        jg::test_case { "no environment => nullopt", [] {
+            std::stringstream json;
+            jg::write_json(json, make_results());
+            jg_test_assert(!jg::read_benchmark_environment(json));
+            std::stringstream csv;
+            jg::write_csv(csv, make_results());
+            jg_test_assert(!jg::read_benchmark_environment(csv));
+        }}
+    }},
+    jg::test_suite { "compare", {
+        jg::test_case { "same samples => unchanged", [] {
+            const auto comparisons = jg::compare(make_baseline(100), make_baseline(100));
+            jg_test_assert(comparisons.size() == 1);
+            jg_test_assert(comparisons[0].change == jg::benchmark_change::unchanged);
+            jg_test_assert(jg::regression_count(comparisons) == 0);
+        }},
+        jg::test_case { "slower samples => regressed", [] {
+            const auto comparisons = jg::compare(make_baseline(100), make_baseline(200));
+            jg_test_assert(comparisons[0].change == jg::benchmark_change::regressed);
+            jg_test_assert(comparisons[0].p_value < 0.05);
+            jg_test_assert(jg::regression_count(comparisons) == 1);
+        }},
+        jg::test_case { "faster samples => improved", [] {
+            const auto comparisons = jg::compare(make_baseline(200), make_baseline(100));
+            jg_test_assert(comparisons[0].change == jg::benchmark_change::improved);
+        }},
+        jg::test_case { "significant but below threshold => unchanged", [] {
+            const auto comparisons = jg::compare(make_baseline(1000), make_baseline(1015));
+            jg_test_assert(comparisons[0].change == jg::benchmark_change::unchanged);
+        }},
+        jg::test_case { "no baseline => left out", [] {
+            auto current = make_baseline(100);
+            current[0].description = "other";
+            jg_test_assert(jg::compare(make_baseline(100), current).empty());
+        }},
+        jg::test_case { "no samples => untested, unchanged", [] {
+            auto current = make_baseline(200);
+            current[0].samples.clear();
+            const auto comparisons = jg::compare(make_baseline(100), current);
+            jg_test_assert(comparisons.size() == 1);
+            jg_test_assert(!comparisons[0].tested);
+            jg_test_assert(comparisons[0].change == jg::benchmark_change::unchanged);
+            jg_test_assert(jg::untested_count(comparisons) == 1);
+            jg_test_assert(jg::untested_count(jg::compare(make_baseline(100), make_baseline(200))) == 0);
+        }}
+    }}
+}};
+
+}
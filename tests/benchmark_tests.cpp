@@ -0,0 +1,392 @@
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+#include <jg_benchmark.h>
+#include <jg_mock.h>
+#include <jg_test.h>
+
+JG_MOCK_REF_EX(,,, void, mock_assert, bool);
+
+namespace {
+
+// Stores `pointer` where the optimizer can't see it being used, so that it can't remove the new and
+// delete pair, which it is allowed to do otherwise.
+void* volatile escaped;
+
+template <typename T>
+T* escape(T* pointer)
+{
+    escaped = pointer;
+    return pointer;
+}
+
+jg::test_adder benchmark_tests { "benchmark", {
+    jg::test_suite { "benchmark", {
+        jg::test_case { "sample_count samples => sample_count results", [] {
+            const auto result = jg::benchmark("empty", 5, 1, [] {});
+            jg_test_assert(result.description == "empty");
+            jg_test_assert(result.samples.size() == 5);
+            jg_test_assert(!result.perf_counters);
+        }},
+        jg::test_case { "func is called sample_count times", [] {
+            size_t calls = 0;
+            jg::benchmark("calls", jg::benchmark_options{7, 3}, [&] { ++calls; });
+            jg_test_assert(calls == 7);
+        }},
+        jg::test_case { "min_time => samples until measured", [] {
+            jg::benchmark_options options{3, 1};
+            options.min_time = std::chrono::milliseconds{5};
+            const auto result = jg::benchmark("sleep", options, [] { std::this_thread::sleep_for(std::chrono::microseconds{500}); });
+            const auto measured = std::accumulate(result.samples.begin(), result.samples.end(), jg::benchmark_result::sample_type{});
+            jg_test_assert(result.samples.size() >= 3);
+            jg_test_assert(std::chrono::nanoseconds{measured} >= options.min_time);
+        }},
+        jg::test_case { "min_time, fully paused func => stops after 10 times min_time", [] {
+            // With the timer overhead subtracted, the samples are mostly 0, so `min_time` is never reached.
+            jg::benchmark_options options{3, 1};
+            options.min_time = std::chrono::milliseconds{50};
+            options.cycle_timing = true;
+            const jg::stopwatch wall;
+            jg::benchmark("fully paused", options, [] (jg::benchmark_state& state) { state.pause_timing(); });
+            jg_test_assert(wall.ms() < 1000);
+        }},
+        jg::test_case { "percentiles are ordered", [] {
+            const auto result = jg::benchmark("ordered", 100, 1, [] {});
+            jg_test_assert(result.median <= result.p90);
+            jg_test_assert(result.p90 <= result.p99);
+            jg_test_assert(result.p99 <= result.p999);
+            jg_test_assert(result.p999 <= result.max);
+        }},
+        jg::test_case { "retain_samples == false => no samples but statistics", [] {
+            jg::benchmark_options options;
+            options.sample_count = 50;
+            options.retain_samples = false;
+            const auto result = jg::benchmark("histogram only", options, [] {
+                volatile int i = 0;
+                while (i < 1000) i = i + 1;
+            });
+            jg_test_assert(result.samples.empty());
+            jg_test_assert(result.median > 0);
+            jg_test_assert(result.average > 0);
+            jg_test_assert(result.max >= result.p99);
+        }},
+        jg::test_case { "no samples, moments => exact average and std_deviation", [] {
+            // 1000 and 1002 share a histogram bucket, so the histogram alone sees no deviation.
+            jg::histogram histogram;
+            jg::stats_accumulator moments;
+
+            for (int i = 0; i < 100; ++i)
+            {
+                histogram.record(i % 2 ? 1002 : 1000);
+                moments.add(i % 2 ? 1002 : 1000);
+            }
+
+            jg::benchmark_result from_histogram;
+            jg::detail::update_statistics(from_histogram, histogram);
+            jg_test_assert(from_histogram.std_deviation == 0);
+
+            jg::benchmark_result from_moments;
+            jg::detail::update_statistics(from_moments, histogram, &moments);
+            jg_test_assert(from_moments.average == 1001);
+            jg_test_assert(from_moments.std_deviation == 1);
+        }}
+    }},
+    jg::test_suite { "benchmark throughput", {
+        jg::test_case { "no items or bytes per iteration => no throughput", [] {
+            const auto result = jg::benchmark("spin", {3, 1}, [] {});
+            jg_test_assert(!result.items_per_second);
+            jg_test_assert(!result.bytes_per_second);
+        }},
+        jg::test_case { "items and bytes per iteration => throughput", [] {
+            jg::benchmark_options options{3, 2};
+            options.items_per_iteration = 10;
+            options.bytes_per_iteration = 40;
+            const auto result = jg::benchmark("sleep", options, [] { std::this_thread::sleep_for(std::chrono::milliseconds{2}); });
+            jg_test_assert(result.items_per_second && *result.items_per_second > 0);
+            jg_test_assert(*result.items_per_second < 10 * 2 * 1000 / 2);
+            jg_test_assert(result.bytes_per_second && std::abs(*result.bytes_per_second - 4 * *result.items_per_second) < 1e-6 * *result.bytes_per_second);
+        }},
+        jg::test_case { "benchmark_range => throughput of the items and bytes per size", [] {
+            jg::benchmark_options options{3, 1};
+            options.items_per_iteration = 2;
+            options.bytes_per_iteration = 8;
+            const auto range = jg::benchmark_range("spin", options, {1, 4}, [] (size_t size) {
+                volatile size_t i = 0;
+                while (i < size * 1000) i = i + 1;
+            });
+
+            // With one iteration per sample, the measured time is the sum of the samples.
+            for (size_t i = 0; i < 2; ++i)
+            {
+                const auto& result = range.results[i];
+                const double size = i == 0 ? 1 : 4;
+                const double seconds = static_cast<double>(std::accumulate(result.samples.begin(), result.samples.end(), jg::benchmark_result::sample_type{})) / 1e9;
+                jg_test_assert(std::abs(*result.items_per_second - 2 * size * 3 / seconds) < 1e-9 * *result.items_per_second);
+                jg_test_assert(std::abs(*result.bytes_per_second - 8 * size * 3 / seconds) < 1e-9 * *result.bytes_per_second);
+            }
+        }}
+    }},
+    jg::test_suite { "benchmark cycle_timing", {
+        jg::test_case { "cycle_timing not enabled => no cycles", [] {
+            jg_test_assert(!jg::benchmark("empty", {3, 1}, [] {}).cycles);
+        }},
+        jg::test_case { "cycle_timing => cycles and calibrated ns", [] {
+            jg::benchmark_options options{3, 2};
+            options.cycle_timing = true;
+            const auto result = jg::benchmark("sleep", options, [] { std::this_thread::sleep_for(std::chrono::milliseconds{2}); });
+            jg_test_assert(result.cycles.has_value());
+            jg_test_assert(result.cycles->ns_per_cycle > 0);
+            jg_test_assert(result.cycles->median > 0);
+            jg_test_assert(result.median >= 900'000);
+            jg_test_assert(std::abs(result.cycles->median * result.cycles->ns_per_cycle - static_cast<double>(result.median)) < 0.02 * static_cast<double>(result.median));
+        }},
+        jg::test_case { "cycle_timing, empty func => overhead subtracted", [] {
+            jg::benchmark_options options{100, 1};
+            options.cycle_timing = true;
+            const auto result = jg::benchmark("empty", options, [] {});
+            jg_test_assert(result.cycles->median < result.cycles->timer_overhead + 100);
+        }}
+    }},
+    jg::test_suite { "benchmark_state", {
+        jg::test_case { "paused sleep => not timed", [] {
+            const auto result = jg::benchmark("paused", {3, 1}, [] (jg::benchmark_state& state) {
+                state.pause_timing();
+                std::this_thread::sleep_for(std::chrono::milliseconds{5});
+                state.resume_timing();
+            });
+            jg_test_assert(result.max < 1'000'000);
+        }},
+        jg::test_case { "resumed sleeps => timed", [] {
+            const auto result = jg::benchmark("resumed", {3, 1}, [] (jg::benchmark_state& state) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                state.pause_timing();
+                state.pause_timing();
+                std::this_thread::sleep_for(std::chrono::milliseconds{5});
+                state.resume_timing();
+                state.resume_timing();
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            });
+            jg_test_assert(result.median >= 2'000'000);
+            jg_test_assert(result.median < 5'000'000);
+        }},
+        jg::test_case { "setup and teardown => called per sample, not timed", [] {
+            size_t setups = 0;
+            size_t teardowns = 0;
+            jg::benchmark_options options{4, 1};
+            options.setup = [&] { ++setups; std::this_thread::sleep_for(std::chrono::milliseconds{2}); };
+            options.teardown = [&] { ++teardowns; std::this_thread::sleep_for(std::chrono::milliseconds{2}); };
+            const auto result = jg::benchmark("fixture", options, [&] { jg_test_assert(setups == teardowns + 1); });
+            jg_test_assert(setups == 4);
+            jg_test_assert(teardowns == 4);
+            jg_test_assert(result.max < 1'000'000);
+        }},
+        jg::test_case { "cold_cache => evicted after setup", [] {
+            std::vector<char> data(64);
+            jg::benchmark_options options{2, 1};
+            options.cold_cache = true;
+            options.setup = [&] { data.assign(data.size(), 1); };
+            const auto result = jg::benchmark("cold", options, [&] { jg_test_assert(data[0] == 1); });
+            jg_test_assert(result.samples.size() == 2);
+        }}
+    }},
+    jg::test_suite { "benchmark_ab", {
+        jg::test_case { "B twice as fast => speedup about 2, significant", [] {
+            const auto ab = jg::benchmark_ab("slow", [] { std::this_thread::sleep_for(std::chrono::milliseconds{4}); },
+                                             "fast", [] { std::this_thread::sleep_for(std::chrono::milliseconds{2}); }, {20, 1});
+            jg_test_assert(ab.a.description == "slow" && ab.b.description == "fast");
+            jg_test_assert(ab.a.samples.size() == 20 && ab.b.samples.size() == 20);
+            jg_test_assert(ab.ratios.size() == 20);
+            jg_test_assert(ab.median_ratio > 1.3 && ab.median_ratio < 2.5);
+            jg_test_assert(ab.speedup.low > 1);
+            jg_test_assert(ab.speedup.low <= ab.median_ratio && ab.median_ratio <= ab.speedup.high);
+        }},
+        jg::test_case { "alternating order => both first equally often", [] {
+            std::string order;
+            (void)jg::benchmark_ab("a", [&] { order += 'a'; }, "b", [&] (jg::benchmark_state&) { order += 'b'; }, {4, 1});
+            jg_test_assert(order == "abbaabba");
+        }},
+        jg::test_case { "options per function => own setup, teardown and internal count", [] {
+            std::string order;
+            jg::benchmark_options options_a{4, 1};
+            jg::benchmark_options options_b{4, 4};
+            options_a.setup = [&] { order += 's'; };
+            options_a.teardown = [&] { order += 't'; };
+            options_b.setup = [&] { order += 'S'; };
+            options_b.teardown = [&] { order += 'T'; };
+            auto sleep = [&] (char c) { order += c; std::this_thread::sleep_for(std::chrono::milliseconds{1}); };
+            const auto ab = jg::benchmark_ab("a", [&] { sleep('a'); }, options_a, "b", [&] { sleep('b'); }, options_b);
+            jg_test_assert(order == "satSbTSbTsatsatSbTSbTsat");
+            // B's per-iteration time is a quarter of A's, as its sample is 4 iterations.
+            jg_test_assert(ab.median_ratio > 2 && ab.median_ratio < 8);
+        }},
+        jg::test_case { "retain_samples == false => no samples but statistics", [] {
+            jg::benchmark_options options{3, 1};
+            options.retain_samples = false;
+            options.min_time = std::chrono::milliseconds{2};
+            auto busy = [] { volatile int i = 0; while (i < 1000) i = i + 1; };
+            const auto ab = jg::benchmark_ab("a", busy, "b", busy, options);
+            jg_test_assert(ab.a.samples.empty() && ab.b.samples.empty());
+            jg_test_assert(ab.a.median > 0 && ab.b.median > 0);
+            jg_test_assert(!ab.ratios.empty());
+        }},
+        jg::test_case { "min_time, fully paused funcs => stops after 10 times min_time", [] {
+            jg::benchmark_options options{3, 1};
+            options.min_time = std::chrono::milliseconds{50};
+            options.cycle_timing = true;
+            // Sleeps while paused, so that the pairs are few enough for a quick bootstrap of the ratios.
+            auto paused = [] (jg::benchmark_state& state) {
+                state.pause_timing();
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            };
+            const jg::stopwatch wall;
+            (void)jg::benchmark_ab("a", paused, "b", paused, options);
+            jg_test_assert(wall.ms() < 1000);
+        }}
+    }},
+    jg::test_suite { "perf_counters", {
+        jg::test_case { "stop without available events => zeroed values", [] {
+            jg::perf_counters counters;
+            counters.start();
+            const auto values = counters.stop();
+            jg_test_assert(counters.available() || values.cycles == 0);
+            jg_test_assert(counters.available() || values.page_faults == 0);
+        }},
+        jg::test_case { "enabled => stats present only when permitted", [] {
+            jg::benchmark_options options;
+            options.perf_counters = true;
+            const auto result = jg::benchmark("counted", options, [] {});
+            jg_test_assert(!result.perf_counters || jg::perf_counters{}.available());
+        }},
+        jg::test_case { "summed values => multiplexed and unscheduled if any part is", [] {
+            jg::perf_counter_values values;
+            jg::perf_counter_values multiplexed;
+            multiplexed.multiplexed = true;
+            jg::perf_counter_values unscheduled;
+            unscheduled.unscheduled = true;
+            values += multiplexed;
+            values += jg::perf_counter_values{};
+            jg_test_assert(values.multiplexed && !values.unscheduled);
+            values += unscheduled;
+            jg_test_assert(values.unscheduled);
+            jg_test_assert(jg::make_perf_counter_stats(values, 1).multiplexed);
+        }},
+        jg::test_case { "make_perf_counter_stats => per-iteration counts and ratios", [] {
+            jg::perf_counter_values values;
+            values.cycles           = 400;
+            values.instructions     = 800;
+            values.cache_references = 10;
+            values.cache_misses     = 5;
+            values.branches         = 0;
+            values.branch_misses    = 2;
+            const auto stats = jg::make_perf_counter_stats(values, 4);
+            jg_test_assert(stats.cycles == 100);
+            jg_test_assert(stats.instructions == 200);
+            jg_test_assert(stats.instructions_per_cycle == 2);
+            jg_test_assert(stats.cache_miss_rate == 0.5);
+            jg_test_assert(stats.branch_miss_rate == 0); // no branch count => no rate
+        }}
+    }},
+    jg::test_suite { "benchmark_range", {
+        jg::test_case { "benchmark_sizes => geometric sequence including last", [] {
+            jg_test_assert((jg::benchmark_sizes(1, 512) == std::vector<size_t>{1, 8, 64, 512}));
+            jg_test_assert((jg::benchmark_sizes(1, 100) == std::vector<size_t>{1, 8, 64, 100}));
+            jg_test_assert((jg::benchmark_sizes(2, 32, 2) == std::vector<size_t>{2, 4, 8, 16, 32}));
+        }},
+        jg::test_case { "one result per size", [] {
+            std::vector<size_t> seen;
+            const auto range = jg::benchmark_range("sizes", {2, 1}, {1, 8, 64}, [&] (size_t n) { seen.push_back(n); });
+            jg_test_assert(range.results.size() == 3);
+            jg_test_assert(range.results[1].description == "sizes/8");
+            jg_test_assert((seen == std::vector<size_t>{1, 1, 8, 8, 64, 64}));
+        }}
+    }},
+    jg::test_suite { "benchmark_threads", {
+        jg::test_case { "benchmark_thread_counts => powers of two including max", [] {
+            jg_test_assert((jg::benchmark_thread_counts(1) == std::vector<size_t>{1}));
+            jg_test_assert((jg::benchmark_thread_counts(6) == std::vector<size_t>{1, 2, 4, 6}));
+        }},
+        jg::test_case { "one run per thread count with per-thread samples", [] {
+            std::atomic<size_t> calls{0};
+            const auto scaling = jg::benchmark_threads("threads", {3, 1}, {1, 2, 4}, [&] (size_t) { ++calls; });
+            jg_test_assert(calls == 3 * (1 + 2 + 4));
+            jg_test_assert(scaling.runs.size() == 3);
+            jg_test_assert(scaling.runs[2].thread_count == 4);
+            jg_test_assert(scaling.runs[2].threads.size() == 4);
+            jg_test_assert(scaling.runs[2].threads[3].samples.size() == 3);
+            jg_test_assert(scaling.runs[2].latency.samples.size() == 12);
+            jg_test_assert(scaling.runs[2].latency.description == "threads/threads:4");
+            jg_test_assert(scaling.runs[0].efficiency == 1.0);
+        }},
+        jg::test_case { "items_per_iteration => summed over the threads' measured time", [] {
+            jg::benchmark_options options{3, 1};
+            options.items_per_iteration = 10;
+            const auto scaling = jg::benchmark_threads("threads", options, {2}, [] {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            });
+            const auto& run = scaling.runs[0];
+            jg_test_assert(run.threads[0].items_per_second.has_value());
+            jg_test_assert(run.latency.items_per_second.has_value());
+            jg_test_assert(!run.latency.bytes_per_second);
+            jg_test_assert(std::abs(*run.latency.items_per_second - 10 * run.throughput) < 1e-6 * *run.latency.items_per_second);
+            jg_test_assert(std::abs(run.throughput - (*run.threads[0].items_per_second + *run.threads[1].items_per_second) / 10) < 1e-6 * run.throughput);
+        }},
+        jg::test_case { "min_time, count_allocations or cycle_timing => assertion", [] {
+            auto asserted = [] (const jg::benchmark_options& options) {
+                bool failed = false;
+                mock_assert_.func = [&] (bool condition) { failed = failed || !condition; };
+                jg::benchmark_threads("threads", options, {1}, [] {});
+                mock_assert_.func = nullptr;
+                mock_assert_.reset();
+                return failed;
+            };
+            jg::benchmark_options options{1, 1};
+            jg_test_assert(!asserted(options));
+            options.min_time = std::chrono::milliseconds{1};
+            jg_test_assert(asserted(options));
+            options = {1, 1};
+            options.count_allocations = true;
+            jg_test_assert(asserted(options));
+            options = {1, 1};
+            options.cycle_timing = true;
+            jg_test_assert(asserted(options));
+        }}
+    }},
+    jg::test_suite { "allocation_counter", {
+        jg::test_case { "JG_ALLOCATION_COUNTER_IMPL defined in tests_main.cpp => available", [] {
+            jg_test_assert(jg::allocation_counter{}.available());
+        }},
+        jg::test_case { "new and delete => counted", [] {
+            jg::allocation_counter counter;
+            counter.start();
+            auto* allocated = escape(new std::vector<int>(100));
+            delete allocated;
+            const auto counts = counter.stop();
+            jg_test_assert(counts.allocations == 2);
+            jg_test_assert(counts.bytes == sizeof(std::vector<int>) + 100 * sizeof(int));
+            jg_test_assert(counts.peak_live_bytes >= static_cast<int64_t>(counts.bytes));
+            jg_test_assert(counts.live_bytes == 0);
+        }},
+        jg::test_case { "not started => not counted", [] {
+            jg::allocation_counter counter;
+            counter.start();
+            const auto counts = counter.stop();
+            delete escape(new int{});
+            jg_test_assert(counts.allocations == 0);
+        }},
+        jg::test_case { "count_allocations => per-iteration stats", [] {
+            jg::benchmark_options options{4, 2};
+            options.count_allocations = true;
+            const auto result = jg::benchmark("allocating", options, [] {
+                delete escape(new int{});
+                delete escape(new int{});
+            });
+            jg_test_assert(result.allocations.has_value());
+            jg_test_assert(result.allocations->allocations == 1);
+            jg_test_assert(result.allocations->bytes == sizeof(int));
+        }}
+    }}
+}};
+
+}
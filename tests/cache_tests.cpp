@@ -0,0 +1,35 @@
+#include <jg_cache.h>
+#include <jg_test.h>
+
+namespace {
+
+jg::test_adder cache_tests { "cache", {
+    jg::test_suite { "parse_cache_size", {
+        jg::test_case { "valid sizes => bytes", [] {
+            jg_test_assert(jg::detail::parse_cache_size("512") == 512u);
+            jg_test_assert(jg::detail::parse_cache_size("32K") == 32u * 1024);
+            jg_test_assert(jg::detail::parse_cache_size("36608K\n") == 36608u * 1024);
+            jg_test_assert(jg::detail::parse_cache_size("2M") == 2u * 1024 * 1024);
+        }},
+        jg::test_case { "invalid sizes => nullopt", [] {
+            jg_test_assert(!jg::detail::parse_cache_size(""));
+            jg_test_assert(!jg::detail::parse_cache_size("K"));
+            jg_test_assert(!jg::detail::parse_cache_size("0K"));
+            jg_test_assert(!jg::detail::parse_cache_size("32X"));
+        }}
+    }},
+    jg::test_suite { "cache_evictor", {
+        jg::test_case { "buffer size => twice the last level cache, or 64 MiB", [] {
+            jg_test_assert(jg::detail::cache_evictor_buffer_size(size_t{36608} << 10) == size_t{73216} << 10);
+            jg_test_assert(jg::detail::cache_evictor_buffer_size(std::nullopt) == size_t{64} << 20);
+        }},
+        jg::test_case { "evict => doesn't crash", [] {
+            jg::cache_evictor evictor{1 << 16};
+            evictor.evict();
+            evictor.evict();
+            jg_test_assert(evictor.buffer_size() == 1 << 16);
+        }}
+    }}
+}};
+
+}
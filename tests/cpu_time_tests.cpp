@@ -0,0 +1,60 @@
+#include <thread>
+#include <jg_cpu_time.h>
+#include <jg_test.h>
+
+namespace {
+
+// Spins until the thread has been on the CPU for `duration`, or for at most a second of wall time, so
+// that other load on the machine doesn't make the tests flaky.
+void spin_for(std::chrono::milliseconds duration)
+{
+    const jg::stopwatch wall;
+    const jg::thread_cpu_stopwatch cpu;
+
+    while (cpu.ns() < std::chrono::nanoseconds{duration}.count() && wall.ms() < 1000)
+        ;
+}
+
+jg::test_adder cpu_time_tests { "cpu_time", {
+    jg::test_suite { "thread_cpu_stopwatch", {
+        jg::test_case { "sleep => little CPU time", [] {
+            jg::thread_cpu_stopwatch cpu;
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            jg_test_assert(cpu.ms() < 10);
+        }},
+        jg::test_case { "spin => CPU time", [] {
+            jg::thread_cpu_stopwatch cpu;
+            spin_for(std::chrono::milliseconds{20});
+            jg_test_assert(cpu.ms() >= 10);
+        }}
+    }},
+    jg::test_suite { "process_cpu_stopwatch", {
+        jg::test_case { "spin => CPU time", [] {
+            jg::process_cpu_stopwatch cpu;
+            spin_for(std::chrono::milliseconds{20});
+            jg_test_assert(cpu.ms() >= 10);
+        }}
+    }},
+    jg::test_suite { "cpu_usage_stopwatch", {
+        jg::test_case { "sleep => wall time, voluntary context switch", [] {
+            jg::cpu_usage_stopwatch usage;
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            const auto u = usage.usage();
+            jg_test_assert(u.wall_ns >= 19'000'000);
+            jg_test_assert(u.user_ns + u.system_ns < u.wall_ns / 2);
+#if !defined(_WIN32)
+            jg_test_assert(u.voluntary_context_switches >= 1);
+#endif
+        }},
+        jg::test_case { "spin => CPU time", [] {
+            jg::cpu_usage_stopwatch usage{jg::cpu_usage_scope::process};
+            spin_for(std::chrono::milliseconds{50});
+            const auto u = usage.usage();
+            jg_test_assert(u.user_ns + u.system_ns >= 40'000'000);
+            jg_test_assert(u.wall_ns >= u.user_ns + u.system_ns - 10'000'000);
+            jg_test_assert(u.voluntary_context_switches >= 0 && u.involuntary_context_switches >= 0);
+        }}
+    }}
+}};
+
+} // namespace
@@ -0,0 +1,27 @@
+#include <chrono>
+#include <thread>
+#include <jg_cycle_clock.h>
+#include <jg_test.h>
+
+namespace {
+
+jg::test_adder cycle_clock_tests { "cycle_clock", {
+    jg::test_suite { "cycle_clock", {
+        jg::test_case { "stop after start => not less", [] {
+            const auto start = jg::cycle_clock::start();
+            jg_test_assert(jg::cycle_clock::stop() >= start);
+        }},
+        jg::test_case { "sleep 5 ms => calibrated to at least 4 ms", [] {
+            const auto start = jg::cycle_clock::start();
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            const auto cycles = jg::cycle_clock::stop() - start;
+            jg_test_assert(static_cast<double>(cycles) * jg::cycle_clock_ns_per_cycle() > 4e6);
+        }},
+        jg::test_case { "overhead => small", [] {
+            jg_test_assert(jg::cycle_clock_overhead() < 10000);
+            jg_test_assert(jg::cycle_clock_overhead() == jg::cycle_clock_overhead());
+        }}
+    }}
+}};
+
+}
@@ -0,0 +1,93 @@
+#include <jg_histogram.h>
+#include <jg_test.h>
+
+namespace {
+
+jg::test_adder histogram_tests { "histogram", {
+    jg::test_suite { "record", {
+        jg::test_case { "empty => zeroed statistics", [] {
+            const jg::histogram histogram;
+            jg_test_assert(histogram.empty());
+            jg_test_assert(histogram.count() == 0);
+            jg_test_assert(histogram.min() == 0);
+            jg_test_assert(histogram.max() == 0);
+            jg_test_assert(histogram.mean() == 0);
+            jg_test_assert(histogram.value_at_percentile(50) == 0);
+        }},
+        jg::test_case { "small values => exact percentiles", [] {
+            jg::histogram histogram;
+            for (uint64_t value = 1; value <= 100; ++value)
+                histogram.record(value);
+            jg_test_assert(histogram.count() == 100);
+            jg_test_assert(histogram.min() == 1);
+            jg_test_assert(histogram.max() == 100);
+            jg_test_assert(histogram.mean() == 50.5);
+            jg_test_assert(histogram.value_at_percentile(50) == 50);
+            jg_test_assert(histogram.value_at_percentile(90) == 90);
+            jg_test_assert(histogram.value_at_percentile(99) == 99);
+            jg_test_assert(histogram.value_at_percentile(100) == 100);
+            jg_test_assert(histogram.value_at_percentile(0) == 1);
+        }},
+        jg::test_case { "large values => percentiles within relative error", [] {
+            jg::histogram histogram;
+            for (uint64_t value = 1; value <= 10000; ++value)
+                histogram.record(value * 1000003);
+            const double p99 = static_cast<double>(histogram.value_at_percentile(99));
+            const double expected = 9900.0 * 1000003;
+            jg_test_assert(std::abs(p99 - expected) / expected < 1.0 / 128);
+            jg_test_assert(histogram.max() == 10000ull * 1000003);
+        }},
+        jg::test_case { "huge value => no overflow", [] {
+            jg::histogram histogram;
+            histogram.record(std::numeric_limits<uint64_t>::max());
+            jg_test_assert(histogram.value_at_percentile(50) == std::numeric_limits<uint64_t>::max());
+        }},
+        jg::test_case { "count => recorded as many values", [] {
+            jg::histogram histogram;
+            histogram.record(7, 3);
+            histogram.record(9);
+            jg_test_assert(histogram.count() == 4);
+            jg_test_assert(histogram.value_at_percentile(75) == 7);
+            jg_test_assert(histogram.value_at_percentile(76) == 9);
+        }}
+    }},
+    jg::test_suite { "merge", {
+        jg::test_case { "merged => same as recorded in one", [] {
+            jg::histogram first;
+            jg::histogram second;
+            jg::histogram both;
+            for (uint64_t value = 0; value < 5000; value += 7)
+            {
+                (value % 2 ? first : second).record(value);
+                both.record(value);
+            }
+            first.merge(second);
+            jg_test_assert(first.count() == both.count());
+            jg_test_assert(first.min() == both.min());
+            jg_test_assert(first.max() == both.max());
+            jg_test_assert(first.value_at_percentile(99.9) == both.value_at_percentile(99.9));
+            jg_test_assert(first.std_deviation() == both.std_deviation());
+        }},
+        jg::test_case { "other with larger values => merged", [] {
+            jg::histogram small;
+            jg::histogram large;
+            small.record(3);
+            large.record(1'000'000'000);
+            jg::histogram merged_into_small = small;
+            merged_into_small.merge(large);
+            large.merge(small);
+            jg_test_assert(merged_into_small.count() == 2 && large.count() == 2);
+            jg_test_assert(merged_into_small.value_at_percentile(50) == 3 && large.value_at_percentile(50) == 3);
+            jg_test_assert(merged_into_small.value_at_percentile(100) == 1'000'000'000 && large.value_at_percentile(100) == 1'000'000'000);
+        }},
+        jg::test_case { "reset => empty", [] {
+            jg::histogram histogram;
+            histogram.record(1234);
+            histogram.reset();
+            jg_test_assert(histogram.empty());
+            jg_test_assert(histogram.max() == 0);
+        }}
+    }}
+}};
+
+}
@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <jg_metrics.h>
+#include <jg_mock.h>
+#include <jg_test.h>
+
+JG_MOCK_REF_EX(,,, void, mock_assert, bool);
+
+namespace {
+
+jg::test_adder metrics_tests { "metrics", {
+    jg::test_suite { "metric_counter", {
+        jg::test_case { "increments from threads => sum", [] {
+            jg::metric_counter counter;
+            std::vector<std::thread> threads;
+
+            for (int t = 0; t < 4; ++t)
+                threads.emplace_back([&counter] {
+                    for (int i = 0; i < 10000; ++i)
+                        counter.increment();
+                });
+
+            for (auto& thread : threads)
+                thread.join();
+
+            counter.increment(5);
+            jg_test_assert(counter.value() == 40005);
+        }}
+    }},
+    jg::test_suite { "metric_gauge", {
+        jg::test_case { "set and add => value", [] {
+            jg::metric_gauge gauge;
+            gauge.add(3);
+            jg_test_assert(gauge.value() == 3);
+            gauge.set(10);
+            jg_test_assert(gauge.value() == 10);
+            gauge.add(-2.5);
+            jg_test_assert(gauge.value() == 7.5);
+        }}
+    }},
+    jg::test_suite { "metric_histogram", {
+        jg::test_case { "observations => buckets, count and sum", [] {
+            jg::metric_histogram histogram{{1, 2, 4}};
+            for (const double value : {0.5, 1.0, 1.5, 3.0, 100.0})
+                histogram.observe(value);
+            const auto values = histogram.values();
+            jg_test_assert(values.bucket_counts == std::vector<uint64_t>({2, 1, 1, 1}));
+            jg_test_assert(values.count == 5);
+            jg_test_assert(values.sum == 106);
+        }},
+        jg::test_case { "observations from threads, more buckets than a cache line => buckets", [] {
+            jg::metric_histogram histogram{jg::exponential_buckets(1, 2, 10)};
+            std::vector<std::thread> threads;
+
+            for (int t = 0; t < 4; ++t)
+                threads.emplace_back([&histogram] {
+                    for (int i = 0; i < 1000; ++i)
+                        histogram.observe(1000);
+                });
+
+            for (auto& thread : threads)
+                thread.join();
+
+            const auto values = histogram.values();
+            jg_test_assert(values.bucket_counts.size() == 11);
+            jg_test_assert(values.bucket_counts[10] == 4000);
+            jg_test_assert(values.count == 4000);
+        }},
+        jg::test_case { "exponential_buckets => powers", [] {
+            jg_test_assert(jg::exponential_buckets(0.5, 2, 4) == std::vector<double>({0.5, 1, 2, 4}));
+        }}
+    }},
+    jg::test_suite { "metrics_registry", {
+        jg::test_case { "same name => same metric", [] {
+            jg::metrics_registry registry;
+            auto& counter = registry.counter("requests_total");
+            counter.increment();
+            jg_test_assert(&registry.counter("requests_total") == &counter);
+            jg_test_assert(registry.snapshot().size() == 1);
+        }},
+        jg::test_case { "invalid name => assertion", [] {
+            jg::metrics_registry registry;
+            mock_assert_.reset();
+            registry.counter("requests_total");
+            jg_test_assert(mock_assert_.param<1>() == true);
+            registry.counter("1requests");
+            jg_test_assert(mock_assert_.param<1>() == false);
+            mock_assert_.reset();
+        }}
+    }},
+    jg::test_suite { "write_prometheus", {
+        jg::test_case { "snapshot => text format", [] {
+            jg::metrics_registry registry;
+            registry.counter("requests_total", "Handled\nrequests.").increment(3);
+            registry.gauge("queue_depth").set(1.5);
+            registry.histogram("latency_seconds", {0.1, 1}).observe(0.5);
+
+            jg_test_assert(jg::to_prometheus(registry.snapshot()) ==
+                "# HELP requests_total Handled\\nrequests.\n"
+                "# TYPE requests_total counter\n"
+                "requests_total 3\n"
+                "# TYPE queue_depth gauge\n"
+                "queue_depth 1.5\n"
+                "# TYPE latency_seconds histogram\n"
+                "latency_seconds_bucket{le=\"0.1\"} 0\n"
+                "latency_seconds_bucket{le=\"1\"} 1\n"
+                "latency_seconds_bucket{le=\"+Inf\"} 1\n"
+                "latency_seconds_sum 0.5\n"
+                "latency_seconds_count 1\n");
+        }},
+        jg::test_case { "value needing 17 digits => round trips", [] {
+            jg::metrics_registry registry;
+            registry.gauge("ratio").set(0.1 + 0.2);
+            jg_test_assert(jg::to_prometheus(registry.snapshot()) == "# TYPE ratio gauge\nratio 0.30000000000000004\n");
+        }},
+        jg::test_case { "write_prometheus_file => file content", [] {
+            jg::metrics_registry registry;
+            registry.counter("written_total").increment();
+            const std::string path = "jg_metrics_tests.prom";
+            jg_test_assert(jg::write_prometheus_file(path, registry.snapshot()));
+            jg_test_assert(jg::write_prometheus_file(path, registry.snapshot()));
+            std::ifstream file{path};
+            const std::string content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+            file.close();
+            std::remove(path.c_str());
+            jg_test_assert(content == jg::to_prometheus(registry.snapshot()));
+        }}
+    }}
+}};
+
+} // namespace
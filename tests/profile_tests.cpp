@@ -0,0 +1,136 @@
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <jg_profile.h>
+#include <jg_test.h>
+
+namespace {
+
+const jg::profile_call_node* find_node(const std::vector<jg::profile_call_node>& nodes, const char* name)
+{
+    for (const auto& node : nodes)
+        if (std::strcmp(node.zone->name, name) == 0)
+            return &node;
+
+    return nullptr;
+}
+
+void profile_leaf()
+{
+    jg_profile_scope("profile_tests leaf");
+    std::this_thread::sleep_for(std::chrono::milliseconds{2});
+}
+
+void profile_recursive(int depth)
+{
+    jg_profile_scope("profile_tests recursive");
+
+    if (depth > 0)
+        profile_recursive(depth - 1);
+}
+
+jg::test_adder profile_tests { "profile", {
+    jg::test_suite { "jg_profile_scope", {
+        jg::test_case { "nested zones => call tree with counts and times", [] {
+            {
+                jg_profile_scope("profile_tests root");
+                profile_leaf();
+                profile_leaf();
+                profile_leaf();
+            }
+
+            const auto report = jg::profile_snapshot();
+            const auto* root = find_node(report.roots, "profile_tests root");
+            jg_test_assert(root && root->count == 1);
+            jg_test_assert(root->children.size() == 1);
+
+            const auto* leaf = find_node(root->children, "profile_tests leaf");
+            jg_test_assert(leaf && leaf->count == 3);
+            jg_test_assert(leaf->inclusive_ns >= 5'000'000);
+            jg_test_assert(leaf->exclusive_ns == leaf->inclusive_ns);
+            jg_test_assert(root->inclusive_ns >= leaf->inclusive_ns);
+            jg_test_assert(root->exclusive_ns <= root->inclusive_ns - leaf->inclusive_ns + 1);
+            jg_test_assert(std::strstr(leaf->zone->location.file_name(), "profile_tests.cpp"));
+        }},
+        jg::test_case { "zones on other threads => merged", [] {
+            auto work = [] {
+                jg_profile_scope("profile_tests thread");
+                profile_leaf();
+            };
+
+            std::thread t1{work};
+            std::thread t2{work};
+            t1.join();
+            t2.join();
+
+            const auto report = jg::profile_snapshot();
+            const auto* thread = find_node(report.roots, "profile_tests thread");
+            jg_test_assert(thread && thread->count == 2);
+            jg_test_assert(find_node(thread->children, "profile_tests leaf")->count == 2);
+        }},
+        jg::test_case { "too deep => dropped", [] {
+            const auto dropped = jg::profile_snapshot().dropped_scopes;
+            profile_recursive(jg::detail::profile_thread::max_depth + 9);
+            jg_test_assert(jg::profile_snapshot().dropped_scopes == dropped + 10);
+        }}
+    }},
+    jg::test_suite { "write_chrome_trace", {
+        jg::test_case { "trace => zones, counters and thread names", [] {
+            jg::start_trace();
+
+            std::thread worker{[] {
+                jg::set_profile_thread_name("profile_tests \"worker\"");
+                jg_profile_scope("profile_tests traced");
+                jg::trace_counter("profile_tests queue", 42.5);
+                profile_leaf();
+            }};
+            worker.join();
+
+            jg::stop_trace();
+
+            {
+                jg_profile_scope("profile_tests untraced");
+            }
+
+            std::ostringstream stream;
+            jg::write_chrome_trace(stream);
+            const auto json = stream.str();
+            jg_test_assert(json.find("{\"traceEvents\": [") == 0);
+            jg_test_assert(json.find("\"args\": {\"name\": \"profile_tests \\\"worker\\\"\"}") != std::string::npos);
+            jg_test_assert(json.find("{\"name\": \"profile_tests traced\", \"ph\": \"X\"") != std::string::npos);
+            jg_test_assert(json.find("{\"name\": \"profile_tests leaf\", \"ph\": \"X\"") != std::string::npos);
+            jg_test_assert(json.find("{\"name\": \"profile_tests queue\", \"ph\": \"C\"") != std::string::npos);
+            jg_test_assert(json.find("\"args\": {\"value\": 42.5}") != std::string::npos);
+            jg_test_assert(json.find("profile_tests untraced") == std::string::npos);
+            jg_test_assert(json.find("\"dropped_events\": 0") != std::string::npos);
+        }},
+        jg::test_case { "full buffer => dropped events", [] {
+            jg::start_trace(2);
+
+            for (int i = 0; i < 5; ++i)
+                jg::trace_counter("profile_tests full", i);
+
+            jg::stop_trace();
+
+            std::ostringstream stream;
+            jg::write_chrome_trace(stream);
+            jg_test_assert(stream.str().find("\"dropped_events\": 3") != std::string::npos);
+        }}
+    }},
+    jg::test_suite { "write_profile", {
+        jg::test_case { "report => indented tree", [] {
+            {
+                jg_profile_scope("profile_tests write");
+                profile_leaf();
+            }
+
+            std::ostringstream stream;
+            jg::write_profile(stream, jg::profile_snapshot());
+            jg_test_assert(stream.str().find("zone") == 0);
+            jg_test_assert(stream.str().find("\nprofile_tests write ") != std::string::npos);
+            jg_test_assert(stream.str().find("\n  profile_tests leaf ") != std::string::npos);
+        }}
+    }}
+}};
+
+} // namespace
@@ -0,0 +1,198 @@
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <random>
+#include <vector>
+#include <jg_algorithm.h>
+#include <jg_reduce.h>
+#include <jg_test.h>
+
+namespace {
+
+std::vector<jg::simd_level> supported_levels()
+{
+    std::vector<jg::simd_level> levels;
+
+    for (auto level : {jg::simd_level::scalar, jg::simd_level::neon, jg::simd_level::avx2, jg::simd_level::avx512})
+        if (jg::is_supported(level))
+            levels.push_back(level);
+
+    return levels;
+}
+
+// Sizes around the vector widths and unroll factors, so that every kernel has a tail.
+std::vector<size_t> test_sizes()
+{
+    std::vector<size_t> sizes;
+
+    for (size_t size = 0; size <= 70; ++size)
+        sizes.push_back(size);
+
+    sizes.push_back(1000);
+    sizes.push_back(1001);
+    return sizes;
+}
+
+std::vector<double> make_doubles(size_t size)
+{
+    std::mt19937_64 engine{size};
+    std::uniform_real_distribution<double> distribution{-1000, 1000};
+    std::vector<double> values(size);
+
+    for (auto& value : values)
+        value = distribution(engine);
+
+    return values;
+}
+
+std::vector<int64_t> make_integers(size_t size)
+{
+    std::mt19937_64 engine{size};
+    std::uniform_int_distribution<int64_t> distribution{-1'000'000'000'000, 1'000'000'000'000};
+    std::vector<int64_t> values(size);
+
+    for (auto& value : values)
+        value = distribution(engine);
+
+    return values;
+}
+
+bool close(double first, double second)
+{
+    return std::abs(first - second) <= 1e-9 * std::max(1.0, std::max(std::abs(first), std::abs(second)));
+}
+
+jg::test_adder reduce_tests { "reduce", {
+    jg::test_suite { "detected_simd_level", {
+        jg::test_case { "detected level => supported, scalar always supported", [] {
+            jg_test_assert(jg::is_supported(jg::detected_simd_level()));
+            jg_test_assert(jg::is_supported(jg::simd_level::scalar));
+        }}
+    }},
+    jg::test_suite { "doubles", {
+        jg::test_case { "all sizes and levels => same as sequential", [] {
+            bool all_close = true;
+
+            for (auto size : test_sizes())
+            {
+                const auto values = make_doubles(size);
+                const jg::span<const double> span{values.data(), values.size()};
+
+                double sum = 0;
+                double squares = 0;
+                for (auto value : values)
+                {
+                    sum += value;
+                    squares += (value - 3) * (value - 3);
+                }
+
+                for (auto level : supported_levels())
+                {
+                    all_close = all_close && close(jg::sum(span, level), sum);
+                    all_close = all_close && close(jg::sum_of_squares(span, 3, level), squares);
+
+                    if (size > 0)
+                    {
+                        const auto [min, max] = jg::min_max(span, level);
+                        all_close = all_close && min == *std::min_element(values.begin(), values.end());
+                        all_close = all_close && max == *std::max_element(values.begin(), values.end());
+                    }
+                }
+            }
+
+            jg_test_assert(all_close);
+        }},
+        jg::test_case { "large mean, small variance => exact variance", [] {
+            std::vector<double> values;
+            for (int i = 0; i < 100; ++i)
+                values.push_back(1e9 + (i % 2 == 0 ? 1 : -1));
+
+            for (auto level : supported_levels())
+            {
+                const auto summary = jg::summarize(jg::span<const double>{values.data(), values.size()}, level);
+                jg_test_assert(summary.count == 100);
+                jg_test_assert(summary.mean == 1e9);
+                jg_test_assert(summary.variance == 1);
+                jg_test_assert(summary.min == 1e9 - 1);
+                jg_test_assert(summary.max == 1e9 + 1);
+            }
+        }},
+        jg::test_case { "empty => empty summary", [] {
+            jg_test_assert(jg::summarize({}).count == 0);
+            jg_test_assert(jg::summarize({}).variance == 0);
+        }}
+    }},
+    jg::test_suite { "64-bit integers", {
+        jg::test_case { "all sizes and levels => same as sequential", [] {
+            bool all_equal = true;
+
+            for (auto size : test_sizes())
+            {
+                const auto values = make_integers(size);
+                const jg::span<const int64_t> span{values.data(), values.size()};
+
+                int64_t sum = 0;
+                double squares = 0;
+                for (auto value : values)
+                {
+                    sum += value;
+                    squares += (static_cast<double>(value) - 3) * (static_cast<double>(value) - 3);
+                }
+
+                for (auto level : supported_levels())
+                {
+                    all_equal = all_equal && jg::sum(span, level) == sum;
+                    all_equal = all_equal && close(jg::sum_of_squares(span, 3, level), squares);
+
+                    if (size > 0)
+                    {
+                        const auto [min, max] = jg::min_max(span, level);
+                        all_equal = all_equal && min == *std::min_element(values.begin(), values.end());
+                        all_equal = all_equal && max == *std::max_element(values.begin(), values.end());
+                    }
+                }
+            }
+
+            jg_test_assert(all_equal);
+        }},
+        jg::test_case { "extreme values => correct min and max", [] {
+            const std::vector<long long> values{0, std::numeric_limits<long long>::max(), 5, std::numeric_limits<long long>::min(), 7, 8, 9, 10, 11};
+
+            for (auto level : supported_levels())
+            {
+                const auto [min, max] = jg::min_max(jg::span<const long long>{values.data(), values.size()}, level);
+                jg_test_assert(min == std::numeric_limits<long long>::min());
+                jg_test_assert(max == std::numeric_limits<long long>::max());
+            }
+        }},
+        jg::test_case { "extreme values => converted to double like static_cast", [] {
+            for (const long long value : {std::numeric_limits<long long>::min(), std::numeric_limits<long long>::max(), -1LL, 0LL, 1LL,
+                                          (1LL << 53) + 1, -(1LL << 53) - 1, 0x123456789abcdefLL, -0x123456789abcdefLL})
+            {
+                // Enough values for the widest kernel, so that none of them are left to the scalar tail.
+                const std::vector<long long> values(32, value);
+
+                for (auto level : supported_levels())
+                    jg_test_assert(jg::sum_of_squares(jg::span<const long long>{values.data(), values.size()}, static_cast<double>(value), level) == 0);
+            }
+        }}
+    }},
+    jg::test_suite { "average and standard_deviation", {
+        jg::test_case { "contiguous and non-contiguous ranges => same result", [] {
+            const auto doubles = make_doubles(101);
+            const std::deque<double> double_deque(doubles.begin(), doubles.end());
+            const double average = jg::average(doubles.begin(), doubles.end());
+            jg_test_assert(close(average, jg::average(double_deque.begin(), double_deque.end())));
+            jg_test_assert(close(jg::standard_deviation(doubles.begin(), doubles.end(), average),
+                                 jg::standard_deviation(double_deque.begin(), double_deque.end(), average)));
+
+            const std::vector<long long> integers{3, 9, -4, 100, 17, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5};
+            const std::deque<long long> integer_deque(integers.begin(), integers.end());
+            jg_test_assert(jg::average(integers.begin(), integers.end()) == jg::average(integer_deque.begin(), integer_deque.end()));
+            jg_test_assert(jg::average(integers.data(), integers.data() + integers.size()) == 10);
+        }}
+    }}
+}};
+
+}
@@ -0,0 +1,96 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <jg_stats_accumulator.h>
+#include <jg_test.h>
+
+namespace {
+
+bool close(double first, double second)
+{
+    return std::abs(first - second) <= 1e-9 * std::max(1.0, std::abs(second));
+}
+
+jg::test_adder stats_accumulator_tests { "stats_accumulator", {
+    jg::test_suite { "stats_accumulator", {
+        jg::test_case { "empty => zeros", [] {
+            jg::stats_accumulator stats;
+            jg_test_assert(stats.empty());
+            jg_test_assert(stats.count() == 0);
+            jg_test_assert(stats.mean() == 0);
+            jg_test_assert(stats.variance() == 0);
+            jg_test_assert(stats.min() == 0 && stats.max() == 0);
+        }},
+        jg::test_case { "values => mean, variance, min and max", [] {
+            jg::stats_accumulator stats;
+            for (const double value : {2, 4, 4, 4, 5, 5, 7, 9})
+                stats.add(value);
+            jg_test_assert(stats.count() == 8);
+            jg_test_assert(stats.mean() == 5);
+            jg_test_assert(stats.variance() == 4);
+            jg_test_assert(stats.std_deviation() == 2);
+            jg_test_assert(stats.min() == 2 && stats.max() == 9);
+        }},
+        jg::test_case { "large offset => variance not lost", [] {
+            jg::stats_accumulator stats;
+            for (int i = 0; i < 1000; ++i)
+                stats.add(1e12 + (i % 2 ? 1 : -1));
+            jg_test_assert(stats.mean() == 1e12);
+            jg_test_assert(stats.variance() > 0.999 && stats.variance() < 1.001);
+        }},
+        jg::test_case { "values => skewness and excess kurtosis", [] {
+            jg::stats_accumulator stats;
+            for (const double value : {2, 4, 4, 4, 5, 5, 7, 9})
+                stats.add(value);
+            jg_test_assert(close(stats.skewness(), 0.65625));
+            jg_test_assert(close(stats.kurtosis(), -0.21875));
+        }},
+        jg::test_case { "equal values => zero skewness and kurtosis", [] {
+            jg::stats_accumulator stats;
+            for (int i = 0; i < 10; ++i)
+                stats.add(3);
+            jg_test_assert(stats.variance() == 0);
+            jg_test_assert(stats.skewness() == 0 && stats.kurtosis() == 0);
+        }}
+    }},
+    jg::test_suite { "merge", {
+        jg::test_case { "merged parts => same as one accumulator", [] {
+            std::mt19937_64 engine{7};
+            std::lognormal_distribution<double> distribution{10, 1};
+            jg::stats_accumulator all;
+            jg::stats_accumulator parts[3];
+
+            for (size_t i = 0; i < 10'000; ++i)
+            {
+                const double value = distribution(engine);
+                all.add(value);
+                parts[i < 100 ? 0 : (i < 7'000 ? 1 : 2)].add(value);
+            }
+
+            jg::stats_accumulator merged;
+            for (const auto& part : parts)
+                merged.merge(part);
+
+            jg_test_assert(merged.count() == all.count());
+            jg_test_assert(close(merged.mean(), all.mean()));
+            jg_test_assert(close(merged.variance(), all.variance()));
+            jg_test_assert(close(merged.skewness(), all.skewness()));
+            jg_test_assert(close(merged.kurtosis(), all.kurtosis()));
+            jg_test_assert(merged.min() == all.min() && merged.max() == all.max());
+            jg_test_assert(all.skewness() > 1); // Log-normal values have a long tail above the mean.
+        }},
+        jg::test_case { "empty merged => unchanged", [] {
+            jg::stats_accumulator stats;
+            stats.add(1);
+            stats.add(3);
+            stats.merge({});
+            jg_test_assert(stats.count() == 2 && stats.mean() == 2 && stats.variance() == 1);
+
+            jg::stats_accumulator empty;
+            empty.merge(stats);
+            jg_test_assert(empty.count() == 2 && empty.mean() == 2 && empty.variance() == 1);
+        }}
+    }}
+}};
+
+} // namespace
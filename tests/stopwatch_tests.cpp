@@ -0,0 +1,57 @@
+#include <thread>
+#include <vector>
+#include <jg_stopwatch.h>
+#include <jg_test.h>
+
+namespace {
+
+template <typename Stopwatch>
+std::vector<jg::test_case> stopwatch_test_cases()
+{
+    return {
+        jg::test_case { "sleep => measured", [] {
+            Stopwatch sw;
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            jg_test_assert(sw.is_running());
+            jg_test_assert(sw.ms() >= 4);
+            jg_test_assert(sw.us() >= 4'000);
+            jg_test_assert(sw.ns() >= 4'000'000);
+        }},
+        jg::test_case { "pause => paused time not measured", [] {
+            Stopwatch sw;
+            sw.pause();
+            sw.pause();
+            jg_test_assert(!sw.is_running());
+            const auto ticks = sw.ticks();
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            jg_test_assert(sw.ticks() == ticks);
+            sw.resume();
+            sw.resume();
+            jg_test_assert(sw.is_running());
+            jg_test_assert(sw.ms() < 20);
+        }},
+        jg::test_case { "lap => time since previous lap", [] {
+            Stopwatch sw;
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            const auto lap1 = sw.lap();
+            const auto lap2 = sw.lap();
+            jg_test_assert(lap1 >= 9'000'000);
+            jg_test_assert(lap2 < lap1);
+        }},
+        jg::test_case { "restart => from 0", [] {
+            Stopwatch sw;
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            sw.pause();
+            sw.restart();
+            jg_test_assert(sw.is_running());
+            jg_test_assert(sw.ms() < 10);
+        }}
+    };
+}
+
+jg::test_adder stopwatch_tests { "stopwatch", {
+    jg::test_suite { "stopwatch", stopwatch_test_cases<jg::stopwatch>() },
+    jg::test_suite { "cycle_stopwatch", stopwatch_test_cases<jg::cycle_stopwatch>() }
+}};
+
+} // namespace
@@ -14,6 +14,10 @@ JG_MOCK_EX(,,, void, mock_assert, bool);
 // For testing that mocking of free functions work. The corresponding JG_MOCK_REF is in mock_tests.cpp.
 JG_MOCK_EX(,,, bool, test_free_function, char, bool, int, const char*);
 
+// For testing that jg::allocation_counter counts. Replaces the global operator new and delete in jg_tests.
+#define JG_ALLOCATION_COUNTER_IMPL
+#include <jg_allocation_counter.h>
+
 #define JG_TEST_MAIN
 #define JG_TEST_IMPL
 #include <jg_test.h>